@@ -0,0 +1,19 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+enum AnimationLoopMode
+{
+    ANIMATION_LOOP,     // back to the first frame after the last
+    ANIMATION_ONCE,     // stops on the last frame
+    ANIMATION_PING_PONG // runs forwards then backwards
+};
+
+// A sprite animation with its frame source rects and durations worked out when the level loads
+struct AnimationClip
+{
+    std::vector<SDL_Rect> frames; // source rects in the sprite's texture
+    std::vector<Uint32> durations; // how long each frame shows, in milliseconds
+    AnimationLoopMode loopMode = ANIMATION_LOOP;
+};
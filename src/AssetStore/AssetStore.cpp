@@ -1,6 +1,9 @@
 #include "AssetStore.h"
 #include "../Logger/Logger.h"
+#include "TextureAtlas.h"
 #include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <memory>
 AssetStore::AssetStore()
 
 {
@@ -15,17 +18,27 @@ AssetStore::~AssetStore()
 
 void AssetStore::ClearAssets()
 {
-    for (auto &texture : textures)
+    for (auto texture : textures)
     {
-        SDL_DestroyTexture(texture.second);
+        SDL_DestroyTexture(texture);
     }
     textures.clear();
+    textureRegions.clear();
+
+    for (auto &surface : pendingSurfaces)
+    {
+        SDL_FreeSurface(surface.second);
+    }
+    pendingSurfaces.clear();
+    atlasesBuilt = false;
 
     for (auto &font : fonts)
     {
         TTF_CloseFont(font.second);
     }
     fonts.clear();
+
+    animationClips.clear();
 }
 
 void AssetStore::AddTexture(SDL_Renderer *renderer, const std::string &assetId, const std::string &filePath)
@@ -37,21 +50,98 @@ void AssetStore::AddTexture(SDL_Renderer *renderer, const std::string &assetId,
         return;
     }
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture)
+    // images too big to share an atlas page keep their own texture, and so do the ones that come after the
+    // atlases were built, nothing would pack them otherwise
+    if (atlasesBuilt || surface->w + TextureAtlas::PADDING * 2 > ATLAS_SIZE / 2 || surface->h + TextureAtlas::PADDING * 2 > ATLAS_SIZE / 2)
+    {
+        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if (!texture)
+        {
+            Logger::Err("Error creating texture from surface: " + filePath);
+            SDL_FreeSurface(surface);
+            return;
+        }
+
+        textures.push_back(texture);
+        textureRegions[assetId] = TextureRegion{texture, {0, 0, surface->w, surface->h}};
+        SDL_FreeSurface(surface);
+        Logger::Log("Texture loaded: " + filePath);
+        return;
+    }
+
+    auto pending = pendingSurfaces.find(assetId);
+    if (pending != pendingSurfaces.end())
+    {
+        SDL_FreeSurface(pending->second);
+    }
+    pendingSurfaces[assetId] = surface;
+    Logger::Log("Texture loaded for the atlas: " + filePath);
+}
+
+void AssetStore::BuildAtlases(SDL_Renderer *renderer)
+{
+    atlasesBuilt = true;
+    if (pendingSurfaces.empty())
     {
-        Logger::Err("Error creating texture from surface: " + filePath);
         return;
     }
 
-    SDL_FreeSurface(surface);
-    textures.emplace(assetId, texture);
-    Logger::Log("Texture loaded: " + filePath);
+    // tallest images first packs the skyline tighter, the id breaks ties so the layout is always the same
+    std::vector<std::pair<std::string, SDL_Surface *>> images(pendingSurfaces.begin(), pendingSurfaces.end());
+    std::sort(images.begin(), images.end(), [](const auto &a, const auto &b)
+              { return a.second->h > b.second->h || (a.second->h == b.second->h && (a.second->w > b.second->w || (a.second->w == b.second->w && a.first < b.first))); });
+
+    std::vector<std::unique_ptr<TextureAtlas>> atlases;
+    std::vector<std::pair<std::string, int>> atlasPerImage;
+    for (auto &image : images)
+    {
+        SDL_Rect rect;
+        size_t page = 0;
+        while (page < atlases.size() && !atlases[page]->Pack(image.second->w, image.second->h, rect))
+        {
+            page++;
+        }
+        if (page == atlases.size())
+        {
+            atlases.push_back(std::make_unique<TextureAtlas>(ATLAS_SIZE, ATLAS_SIZE));
+            atlases.back()->Pack(image.second->w, image.second->h, rect);
+        }
+
+        atlases[page]->Blit(image.second, rect);
+        textureRegions[image.first] = TextureRegion{nullptr, rect};
+        atlasPerImage.push_back({image.first, page});
+        SDL_FreeSurface(image.second);
+    }
+    pendingSurfaces.clear();
+
+    std::vector<SDL_Texture *> pages;
+    for (auto &atlas : atlases)
+    {
+        pages.push_back(atlas->CreateTexture(renderer));
+        textures.push_back(pages.back());
+    }
+    for (auto &image : atlasPerImage)
+    {
+        textureRegions[image.first].texture = pages[image.second];
+    }
+
+    Logger::Log("Packed " + std::to_string(images.size()) + " textures into " + std::to_string(pages.size()) + " atlas pages");
 }
 
 SDL_Texture *AssetStore::GetTexture(const std::string &assetId)
 {
-    return textures[assetId];
+    return GetTextureRegion(assetId).texture;
+}
+
+const TextureRegion &AssetStore::GetTextureRegion(const std::string &assetId)
+{
+    auto region = textureRegions.find(assetId);
+    if (region == textureRegions.end())
+    {
+        static const TextureRegion missing;
+        return missing;
+    }
+    return region->second;
 }
 
 void AssetStore::AddFont(const std::string &assetId, const std::string &filePath, int fontSize)
@@ -70,4 +160,15 @@ void AssetStore::AddFont(const std::string &assetId, const std::string &filePath
 TTF_Font *AssetStore::GetFont(const std::string &assetId)
 {
     return fonts[assetId];
-}
\ No newline at end of file
+}
+
+void AssetStore::AddAnimationClip(const std::string &assetId, const AnimationClip &clip)
+{
+    animationClips[assetId] = clip;
+}
+
+const AnimationClip *AssetStore::GetAnimationClip(const std::string &assetId) const
+{
+    auto clip = animationClips.find(assetId);
+    return clip != animationClips.end() ? &clip->second : nullptr;
+}
@@ -2,14 +2,29 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include "AnimationClip.h"
+
+// Where an asset's pixels are: rect is the asset inside texture, which is an atlas page or the asset's own texture
+struct TextureRegion
+{
+    SDL_Texture *texture = nullptr;
+    SDL_Rect rect = {0, 0, 0, 0};
+};
 
 class AssetStore
 {
 private:
-    std::map<std::string, SDL_Texture *> textures;
+    std::map<std::string, TextureRegion> textureRegions;
+    std::vector<SDL_Texture *> textures; // every texture the regions point to, atlas pages and standalone textures
     std::map<std::string, TTF_Font *> fonts;
+    std::map<std::string, AnimationClip> animationClips;
+
+    // images loaded before BuildAtlases, waiting to be packed
+    std::map<std::string, SDL_Surface *> pendingSurfaces;
+    bool atlasesBuilt = false;
 
     // TODO: create a map for audio
 
@@ -18,9 +33,22 @@ public:
     ~AssetStore();
 
     void ClearAssets();
+    static constexpr int ATLAS_SIZE = 2048;
+
+    // Images that fit in an atlas are only loaded here, they get their texture when BuildAtlases is called.
+    // Images added after the atlases were built get their own texture right away.
     void AddTexture(SDL_Renderer *renderer, const std::string &assetId, const std::string &filePath);
+    // Packs the pending images into as few ATLAS_SIZE atlas pages as possible
+    void BuildAtlases(SDL_Renderer *renderer);
+
+    // The texture holding the asset, draws must offset their source rect by GetTextureRegion(assetId).rect
     SDL_Texture *GetTexture(const std::string &assetId);
+    const TextureRegion &GetTextureRegion(const std::string &assetId);
 
     void AddFont(const std::string &assetId, const std::string &filePath, int fontSize);
     TTF_Font *GetFont(const std::string &assetId);
+
+    // Clips stay at the same address until the assets are cleared, components point to them
+    void AddAnimationClip(const std::string &assetId, const AnimationClip &clip);
+    const AnimationClip *GetAnimationClip(const std::string &assetId) const;
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "TextureAtlas.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <climits>
+
+TextureAtlas::TextureAtlas(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    skyline.push_back({0, 0, width});
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    if (surface)
+    {
+        SDL_FreeSurface(surface);
+    }
+}
+
+// The lowest y an image of this size can sit at with its left edge on the node, false if it runs off the atlas
+bool TextureAtlas::FitsAt(int node, int rectWidth, int rectHeight, int &y) const
+{
+    int x = skyline[node].x;
+    if (x + rectWidth > width)
+    {
+        return false;
+    }
+
+    y = skyline[node].y;
+    int widthLeft = rectWidth;
+    for (int i = node; widthLeft > 0; i++)
+    {
+        y = std::max(y, skyline[i].y);
+        if (y + rectHeight > height)
+        {
+            return false;
+        }
+        widthLeft -= skyline[i].width;
+    }
+    return true;
+}
+
+void TextureAtlas::AddSkylineNode(int node, const SDL_Rect &rect)
+{
+    skyline.insert(skyline.begin() + node, {rect.x, rect.y + rect.h, rect.w});
+
+    // the new segment covers the start of the ones after it, shrink or drop them
+    for (size_t i = node + 1; i < skyline.size();)
+    {
+        int coveredEnd = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= coveredEnd)
+        {
+            break;
+        }
+        int shrink = coveredEnd - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0)
+        {
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // merge neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+bool TextureAtlas::Pack(int rectWidth, int rectHeight, SDL_Rect &rect)
+{
+    int paddedWidth = rectWidth + PADDING * 2;
+    int paddedHeight = rectHeight + PADDING * 2;
+
+    int bestNode = -1;
+    int bestTop = INT_MAX;
+    int bestX = INT_MAX;
+    for (size_t node = 0; node < skyline.size(); node++)
+    {
+        int y;
+        if (FitsAt(node, paddedWidth, paddedHeight, y) && (y + paddedHeight < bestTop || (y + paddedHeight == bestTop && skyline[node].x < bestX)))
+        {
+            bestNode = node;
+            bestTop = y + paddedHeight;
+            bestX = skyline[node].x;
+        }
+    }
+    if (bestNode < 0)
+    {
+        return false;
+    }
+
+    SDL_Rect padded = {bestX, bestTop - paddedHeight, paddedWidth, paddedHeight};
+    AddSkylineNode(bestNode, padded);
+    rect = {padded.x + PADDING, padded.y + PADDING, rectWidth, rectHeight};
+    return true;
+}
+
+void TextureAtlas::Blit(SDL_Surface *image, const SDL_Rect &rect)
+{
+    if (!surface)
+    {
+        surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!surface)
+        {
+            Logger::Err("Error creating texture atlas surface: " + std::string(SDL_GetError()));
+            return;
+        }
+        SDL_FillRect(surface, NULL, 0);
+    }
+
+    // copy the pixels as they are, alpha included, instead of blending them over the empty atlas
+    SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+    SDL_Rect dstRect = rect;
+    SDL_BlitSurface(image, NULL, surface, &dstRect);
+}
+
+SDL_Texture *TextureAtlas::CreateTexture(SDL_Renderer *renderer)
+{
+    if (!surface)
+    {
+        return nullptr;
+    }
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!texture)
+    {
+        Logger::Err("Error creating texture atlas texture: " + std::string(SDL_GetError()));
+    }
+    SDL_FreeSurface(surface);
+    surface = nullptr;
+    return texture;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+/*
+TextureAtlas
+Packs images into one large surface with a skyline bottom-left packer: the top edge of the packed images is kept
+as a list of horizontal segments and each image goes where it would sit lowest, then leftmost.
+Once everything is packed the surface is uploaded as a single texture.
+*/
+class TextureAtlas
+{
+private:
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    int width;
+    int height;
+    std::vector<SkylineNode> skyline;
+    SDL_Surface *surface = nullptr;
+
+    bool FitsAt(int node, int rectWidth, int rectHeight, int &y) const;
+    void AddSkylineNode(int node, const SDL_Rect &rect);
+
+public:
+    // empty pixels left around each image so sampling one never picks up its neighbours
+    static const int PADDING = 1;
+
+    TextureAtlas(int width, int height);
+    ~TextureAtlas();
+
+    // Finds room for a width x height image, returns false when the atlas is full
+    bool Pack(int rectWidth, int rectHeight, SDL_Rect &rect);
+
+    // Copies the image into a rect returned by Pack
+    void Blit(SDL_Surface *image, const SDL_Rect &rect);
+
+    // Uploads the packed surface as a texture, the surface is freed
+    SDL_Texture *CreateTexture(SDL_Renderer *renderer);
+};
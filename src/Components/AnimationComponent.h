@@ -1,6 +1,7 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include "../AssetStore/AnimationClip.h"
 
 struct AnimationComponent
 {
@@ -11,12 +12,21 @@ struct AnimationComponent
     bool isLoop;
     int startTime;
 
-    AnimationComponent(int numFrames = 1, int frameSpeedRate = 1, bool isLoop = true)
+    // frames, durations and loop mode come from the clip when there is one,
+    // otherwise numFrames frames of the sprite's width side by side at frameSpeedRate frames per second
+    const AnimationClip *clip;
+    int direction; // 1 or -1, for ping pong clips
+    bool isFinished;
+
+    AnimationComponent(int numFrames = 1, int frameSpeedRate = 1, bool isLoop = true, const AnimationClip *clip = nullptr)
     {
         this->numFrames = numFrames;
         this->frameSpeedRate = frameSpeedRate;
         this->isLoop = isLoop;
-        this->currentFrame = 1;
-        this->startTime = 1;
+        this->currentFrame = 0;
+        this->startTime = 0;
+        this->clip = clip;
+        this->direction = 1;
+        this->isFinished = false;
     }
-};
\ No newline at end of file
+};
@@ -2,17 +2,37 @@
 
 #include <glm/glm.hpp>
 
+// Collision layers, a collider is only tested against colliders whose layer is in its collision mask
+enum CollisionLayer : unsigned int
+{
+    COLLISION_LAYER_DEFAULT = 1 << 0,
+    COLLISION_LAYER_PLAYER = 1 << 1,
+    COLLISION_LAYER_ENEMY = 1 << 2,
+    COLLISION_LAYER_PROJECTILE = 1 << 3,
+    COLLISION_LAYER_OBSTACLE = 1 << 4,
+    COLLISION_LAYER_TILE = 1 << 5,
+    COLLISION_LAYER_ALL = 0xFFFFFFFF
+};
+
 struct BoxColliderComponent
 {
 public:
     int width;
     int height;
     glm::vec2 offset;
+    bool isStatic; // static colliders never move and are never tested against each other
+    unsigned int layer;
+    unsigned int collisionMask;
+    bool isBullet; // fast movers, tested with a swept box from last frame's position so they can't tunnel through thin colliders
 
-    BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0))
+    BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0), bool isStatic = false, unsigned int layer = COLLISION_LAYER_DEFAULT, unsigned int collisionMask = COLLISION_LAYER_ALL, bool isBullet = false)
     {
         this->width = width;
         this->height = height;
         this->offset = offset;
+        this->isStatic = isStatic;
+        this->layer = layer;
+        this->collisionMask = collisionMask;
+        this->isBullet = isBullet;
     }
 };
\ No newline at end of file
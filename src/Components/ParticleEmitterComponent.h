@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <SDL2/SDL.h>
+
+// Particles are not entities, the emitter only describes them. They are simulated and drawn by the ParticleSystem.
+struct ParticleEmitterComponent
+{
+    std::string assetId;
+    int width; // of one frame, the frames are laid out left to right in the image
+    int height;
+    int numFrames;
+    bool isAnimated;  // play the frames over the life of a particle, otherwise each particle keeps a random frame
+    float rate;       // particles per second
+    int burst;        // particles emitted at once when the emitter starts
+    int duration;     // ms to keep emitting, 0 to emit for as long as the entity lives
+    glm::vec2 offset; // from the entity position
+    float direction;  // degrees, 0 is right and 90 is down
+    float spread;     // degrees around the direction
+    float minSpeed;
+    float maxSpeed;
+    int minLife; // ms
+    int maxLife;
+    glm::vec2 acceleration;
+    float scale;
+    SDL_Color color;
+    bool isFading; // fade out over the life of a particle
+
+    // set by the ParticleSystem
+    int pool;
+    double pendingParticles;
+    double elapsed; // ms since the emitter started
+
+    ParticleEmitterComponent(std::string assetId = "", int width = 0, int height = 0, int numFrames = 1, float rate = 0.0f, int minLife = 1000, int maxLife = 1000, float minSpeed = 0.0f, float maxSpeed = 0.0f)
+    {
+        this->assetId = assetId;
+        this->width = width;
+        this->height = height;
+        this->numFrames = numFrames;
+        this->isAnimated = true;
+        this->rate = rate;
+        this->burst = 0;
+        this->duration = 0;
+        this->offset = glm::vec2(0);
+        this->direction = 0.0f;
+        this->spread = 360.0f;
+        this->minSpeed = minSpeed;
+        this->maxSpeed = maxSpeed;
+        this->minLife = minLife;
+        this->maxLife = maxLife;
+        this->acceleration = glm::vec2(0);
+        this->scale = 1.0f;
+        this->color = {255, 255, 255, 255};
+        this->isFading = true;
+        this->pool = -1;
+        this->pendingParticles = 0.0;
+        this->elapsed = 0.0;
+    }
+};
@@ -1,13 +1,14 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include "../Game/TimerHandle.h"
 
 struct ProjectileComponent
 {
     bool isFriendly;
     int damage;
     int duration;
-    int startTime;
+    TimerHandle expiryTimer; // kills the projectile once its duration is over
     int ownerEntityId;
 
     ProjectileComponent(bool isFriendly = false, int damage = 0, int duration = 0, int ownerEntityId = 0)
@@ -17,6 +18,5 @@ struct ProjectileComponent
         this->damage = damage;
         this->duration = duration;
         this->ownerEntityId = ownerEntityId;
-        this->startTime = SDL_GetTicks();
     }
 };
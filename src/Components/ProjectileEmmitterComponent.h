@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 #include <SDL2/SDL.h>
+#include "../Game/TimerHandle.h"
 
 struct ProjectileEmitterComponent
 {
@@ -11,7 +12,8 @@ struct ProjectileEmitterComponent
     int projectileDuration; // ms to keep alive
     bool isFriendly;
     int hitPercentageDamage;
-    int lastEmmissionTime;
+    int lastEmmissionTime; // SDL_GetTicks of the last shot fired with the key, paces the player
+    TimerHandle emissionTimer; // fires every frequency ms
 
     ProjectileEmitterComponent(glm::vec2 projectileVelocity = glm::vec2(0), int frequency = 0, int projectileDuration = 10000, bool isFriendly = true, int hitPercentageDamage = 10)
 
@@ -5,6 +5,7 @@
 struct TransformComponent
 {
     glm::vec2 position;
+    glm::vec2 previousPosition; // position at the start of the last simulation tick, rendering interpolates from it
     glm::vec2 scale;
     double rotation;
     bool isFixed;
@@ -12,6 +13,7 @@ struct TransformComponent
     TransformComponent(glm::vec2 position = glm::vec2(0, 0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0, bool isFixed = false)
     {
         this->position = position;
+        this->previousPosition = position;
         this->scale = scale;
         this->rotation = rotation;
         this->isFixed = isFixed;
@@ -1,5 +1,6 @@
 #include "ECS.h"
 #include "../Logger/Logger.h"
+#include "../Physics/SpatialQuery.h"
 
 // initialize static member variable
 int IComponent::nextId = 0;
@@ -36,18 +37,63 @@ bool Entity::BelongsToGroup(const std::string &group) const
 
 void System::AddEntityToSystem(Entity entity)
 {
+    if (entity.GetId() >= static_cast<int>(entityIndices.size()))
+    {
+        entityIndices.resize(entity.GetId() + 1, -1);
+    }
+    entityIndices[entity.GetId()] = entities.size();
     entities.push_back(entity);
 }
 
 void System::RemoveEntityFromSystem(Entity entity)
 {
-    entities.erase(std::remove(entities.begin(), entities.end(), entity),
-                   entities.end());
+    if (!HasEntity(entity))
+    {
+        return;
+    }
+    entities[entityIndices[entity.GetId()]] = Entity(-1);
+    entityIndices[entity.GetId()] = -1;
+    removedCount++;
+    if (removedCount * 2 > static_cast<int>(entities.size()))
+    {
+        CompactEntities();
+    }
+}
+
+// Drops the removed entities while keeping the order of the others, so systems still see them in the order they joined
+void System::CompactEntities()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        if (entities[i].GetId() < 0)
+        {
+            continue;
+        }
+        entityIndices[entities[i].GetId()] = kept;
+        entities[kept++] = entities[i];
+    }
+    entities.erase(entities.begin() + kept, entities.end());
+    removedCount = 0;
+}
+
+bool System::HasEntity(Entity entity) const
+{
+    return entity.GetId() >= 0 && entity.GetId() < static_cast<int>(entityIndices.size()) && entityIndices[entity.GetId()] >= 0;
 }
 
 std::vector<Entity> System::GetSystemEntities() const
 {
-    return entities;
+    std::vector<Entity> systemEntities;
+    systemEntities.reserve(entities.size() - removedCount);
+    for (const auto &entity : entities)
+    {
+        if (entity.GetId() >= 0)
+        {
+            systemEntities.push_back(entity);
+        }
+    }
+    return systemEntities;
 }
 
 const Signature &System::GetComponentSignature() const
@@ -72,6 +118,7 @@ Entity Registry::CreateEntity()
         if (entityId >= entityComponentSignatures.size())
         {
             entityComponentSignatures.resize(entityId + 1);
+            pooledEntities.resize(entityId + 1);
         }
     }
 
@@ -85,6 +132,22 @@ Entity Registry::CreateEntity()
 
 void Registry::KillEntity(Entity entity)
 {
+    PooledEntity &pooled = pooledEntities[entity.GetId()];
+    if (pooled.pool >= 0)
+    {
+        if (pooled.state == POOLED_WAKING)
+        {
+            // it never joined the systems, it can go straight back
+            pooled.state = POOLED_ASLEEP;
+            entityPools[pooled.pool].sleepingEntities.push_back(entity);
+        }
+        else if (pooled.state == POOLED_AWAKE)
+        {
+            pooled.state = POOLED_SLEEPING;
+            pooledEntitiesToSleep.push_back(entity);
+        }
+        return;
+    }
 
     // Remove the entity from the set of entities to be destroyed
     entitiesToBeKilled.insert(entity);
@@ -101,6 +164,18 @@ void Registry::Update()
 
     entitiesToBeAdded.clear();
 
+    // an entity killed and woken again before this update is in the list twice, it only joins once
+    for (auto entity : pooledEntitiesToWake)
+    {
+        PooledEntity &pooled = pooledEntities[entity.GetId()];
+        if (pooled.state == POOLED_WAKING)
+        {
+            AddEntityToSystems(entity);
+            pooled.state = POOLED_AWAKE;
+        }
+    }
+    pooledEntitiesToWake.clear();
+
     for (auto entity : entitiesToBeKilled)
     {
         RemoveEntityFromSystems(entity);
@@ -120,6 +195,55 @@ void Registry::Update()
         }
     }
     entitiesToBeKilled.clear();
+
+    for (auto entity : pooledEntitiesToSleep)
+    {
+        RemoveEntityFromSystems(entity);
+        PooledEntity &pooled = pooledEntities[entity.GetId()];
+        pooled.state = POOLED_ASLEEP;
+        entityPools[pooled.pool].sleepingEntities.push_back(entity);
+    }
+    pooledEntitiesToSleep.clear();
+}
+
+int Registry::CreateEntityPool(std::function<void(Entity &)> buildEntity, int count)
+{
+    int pool = entityPools.size();
+    entityPools.push_back(EntityPool{buildEntity, {}});
+    entityPools[pool].sleepingEntities.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        CreatePooledEntity(pool);
+    }
+    return pool;
+}
+
+void Registry::CreatePooledEntity(int pool)
+{
+    Entity entity = CreateEntity();
+    entitiesToBeAdded.erase(entity); // it only joins the systems once it is woken up
+    entityPools[pool].buildEntity(entity);
+    pooledEntities[entity.GetId()] = PooledEntity{pool, POOLED_ASLEEP};
+    entityPools[pool].sleepingEntities.push_back(entity);
+}
+
+Entity Registry::WakePooledEntity(int pool)
+{
+    auto &sleepingEntities = entityPools[pool].sleepingEntities;
+    if (sleepingEntities.empty())
+    {
+        CreatePooledEntity(pool);
+    }
+    Entity entity = sleepingEntities.back();
+    sleepingEntities.pop_back();
+    pooledEntities[entity.GetId()].state = POOLED_WAKING;
+    pooledEntitiesToWake.push_back(entity);
+    return entity;
+}
+
+int Registry::GetSleepingEntityCount(int pool) const
+{
+    return entityPools[pool].sleepingEntities.size();
 }
 
 // Adds an entity to the System if the entity contains all of the required components
@@ -144,9 +268,13 @@ void Registry::AddEntityToSystems(Entity entity)
 // Removes an entity from the System
 void Registry::RemoveEntityFromSystems(Entity entity)
 {
+    // only the systems that have the entity, so removing one costs the same however many entities the others hold
     for (auto &system : systems)
     {
-        system.second->RemoveEntityFromSystem(entity);
+        if (system.second->HasEntity(entity))
+        {
+            system.second->RemoveEntityFromSystem(entity);
+        }
     }
 }
 
@@ -201,4 +329,38 @@ void Registry::RemoveEntityFromGroup(Entity entity)
     entitiesPerGroup[group].erase(entity);
 
     groupPerEntity.erase(entity.GetId());
-}
\ No newline at end of file
+}
+void Registry::SetSpatialQuery(ISpatialQuery *spatialQuery)
+{
+    this->spatialQuery = spatialQuery;
+}
+
+void Registry::QueryAABB(const AABB &region, std::vector<Entity> &results, unsigned int mask) const
+{
+    if (!spatialQuery)
+    {
+        Logger::Err("Spatial query made before the registry has a spatial query set");
+        return;
+    }
+    spatialQuery->QueryAABB(region, mask, results);
+}
+
+void Registry::QueryRadius(const glm::vec2 &center, float radius, std::vector<Entity> &results, unsigned int mask) const
+{
+    if (!spatialQuery)
+    {
+        Logger::Err("Spatial query made before the registry has a spatial query set");
+        return;
+    }
+    spatialQuery->QueryRadius(center, radius, mask, results);
+}
+
+void Registry::Raycast(const glm::vec2 &from, const glm::vec2 &to, std::vector<EntityHit> &hits, unsigned int mask) const
+{
+    if (!spatialQuery)
+    {
+        Logger::Err("Spatial query made before the registry has a spatial query set");
+        return;
+    }
+    spatialQuery->RayCast(from, to, mask, hits);
+}
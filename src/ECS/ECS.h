@@ -9,6 +9,8 @@
 #include <iostream>
 #include <queue>
 #include <unordered_set>
+#include <functional>
+#include <glm/glm.hpp>
 
 const unsigned int MAX_COMPONENTS = 32;
 
@@ -93,6 +95,14 @@ public:
     class Registry *registry;
 };
 
+// A ray hit returned by Registry::Raycast
+struct EntityHit
+{
+    Entity entity;
+    float fraction; // 0 at the start of the ray, 1 at the end
+    glm::vec2 point;
+};
+
 /*
 System
 The system processes entities that contain a specific signature.
@@ -102,14 +112,23 @@ class System
 {
 private:
     Signature componentSignature;
+
+    // Removed entities are only marked (id -1) so removing one doesn't shift the rest, they are compacted away
+    // once they make up half of the list. entityIndices has the position of every entity id, -1 when not here.
     std::vector<Entity> entities;
+    std::vector<int> entityIndices;
+    int removedCount = 0;
+
+    void CompactEntities();
 
 public:
     System() = default;
-    ~System() = default;
+    virtual ~System() = default;
 
-    void AddEntityToSystem(Entity entity);
-    void RemoveEntityFromSystem(Entity entity);
+    // virtual so systems that keep extra per-entity state can stay in sync with their entity list
+    virtual void AddEntityToSystem(Entity entity);
+    virtual void RemoveEntityFromSystem(Entity entity);
+    bool HasEntity(Entity entity) const;
     std::vector<Entity> GetSystemEntities() const;
     const Signature &GetComponentSignature() const;
 
@@ -206,6 +225,44 @@ private:
     // List of available entity ids that were previously removed
     std::queue<int> freeIds;
 
+    // answers the spatial queries, set once the collision system exists
+    class ISpatialQuery *spatialQuery = nullptr;
+
+    // Entity pools
+    // pooled entities are recycled instead of destroyed: killing one puts it to sleep, out of every system,
+    // and it keeps its id, components and group until it is woken up again
+    enum PooledState
+    {
+        POOLED_NONE,
+        POOLED_ASLEEP,
+        POOLED_WAKING,
+        POOLED_AWAKE,
+        POOLED_SLEEPING
+    };
+
+    struct PooledEntity
+    {
+        int pool = -1;
+        PooledState state = POOLED_NONE;
+    };
+
+    struct EntityPool
+    {
+        std::function<void(Entity &)> buildEntity;
+        std::vector<Entity> sleepingEntities;
+    };
+
+    std::vector<EntityPool> entityPools;
+
+    // vector index = entity ID
+    std::vector<PooledEntity> pooledEntities;
+
+    // vectors rather than sets so waking and killing pooled entities doesn't allocate once they have grown
+    std::vector<Entity> pooledEntitiesToWake;
+    std::vector<Entity> pooledEntitiesToSleep;
+
+    void CreatePooledEntity(int pool);
+
 public:
     Registry() = default;
 
@@ -234,6 +291,22 @@ public:
     std::set<Entity> GetEntitiesByGroup(const std::string &group) const;
     void RemoveEntityFromGroup(Entity entity);
 
+    // Entity pools
+    // buildEntity adds the components every entity of the pool has, count entities are created asleep right away
+    int CreateEntityPool(std::function<void(Entity &)> buildEntity, int count);
+    // Takes a sleeping entity out of the pool, a new one is built when the pool is empty.
+    // The caller resets its components, it joins the systems on the next update
+    Entity WakePooledEntity(int pool);
+    int GetSleepingEntityCount(int pool) const;
+
+    // Spatial queries
+    // backed by the collision broad phase, so only entities with a box collider are found.
+    // Results are appended to the caller's buffer and the mask filters on the collider layer.
+    void SetSpatialQuery(class ISpatialQuery *spatialQuery);
+    void QueryAABB(const struct AABB &region, std::vector<Entity> &results, unsigned int mask = 0xFFFFFFFF) const;
+    void QueryRadius(const glm::vec2 &center, float radius, std::vector<Entity> &results, unsigned int mask = 0xFFFFFFFF) const;
+    void Raycast(const glm::vec2 &from, const glm::vec2 &to, std::vector<EntityHit> &hits, unsigned int mask = 0xFFFFFFFF) const;
+
     ////////////////////////////////////////////////////////////////////////////////////////////
     // Components
     ////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +80,14 @@ public:
         subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
     }
 
+    // Whether anyone listens to events of type T, to skip building events nobody handles
+    template <typename TEvent>
+    bool HasSubscribers() const
+    {
+        auto handlers = subscribers.find(typeid(TEvent));
+        return handlers != subscribers.end() && handlers->second && !handlers->second->empty();
+    }
+
     // Execute listener callback functions
     template <typename TEvent, typename... TArgs>
     void EmitEvent(TArgs &&...args)
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "CollisionEvent.h"
+
+// Emitted on the first frame two colliders overlap
+class CollisionEnterEvent : public CollisionEvent
+{
+public:
+    CollisionEnterEvent(Entity entity1, Entity entity2) : CollisionEvent(entity1, entity2) {}
+};
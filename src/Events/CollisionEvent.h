@@ -3,6 +3,7 @@
 #include "../ECS/ECS.h"
 #include "../EventBus/Event.h"
 
+// Base for the collision events, CollisionSystem emits the Enter/Stay/Exit events below
 class CollisionEvent : public Event
 {
 public:
@@ -10,4 +11,4 @@ public:
     Entity entity2;
 
     CollisionEvent(Entity entity1, Entity entity2) : entity1(entity1), entity2(entity2) {}
-};
\ No newline at end of file
+};
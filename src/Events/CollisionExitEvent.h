@@ -0,0 +1,10 @@
+#pragma once
+
+#include "CollisionEvent.h"
+
+// Emitted on the first frame two colliders that were overlapping are apart again
+class CollisionExitEvent : public CollisionEvent
+{
+public:
+    CollisionExitEvent(Entity entity1, Entity entity2) : CollisionEvent(entity1, entity2) {}
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "CollisionEvent.h"
+
+// Emitted on every following frame the two colliders keep overlapping, only while something subscribes to it
+class CollisionStayEvent : public CollisionEvent
+{
+public:
+    CollisionStayEvent(Entity entity1, Entity entity2) : CollisionEvent(entity1, entity2) {}
+};
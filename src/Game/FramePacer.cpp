@@ -0,0 +1,153 @@
+#include "FramePacer.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cmath>
+
+// power save never runs faster than this, whatever the target rate
+const double POWER_SAVE_RATE = 30.0;
+const double MIN_SPIN_SECONDS = 0.0005;
+const double MAX_SPIN_SECONDS = 0.004;
+
+FramePacer::FramePacer(FramePacingMode mode, double targetRate)
+{
+    this->mode = mode;
+    this->targetRate = targetRate;
+    frequency = SDL_GetPerformanceFrequency();
+    frameTimes.reserve(STATS_FRAME_COUNT);
+    Reset();
+}
+
+void FramePacer::SetMode(FramePacingMode mode)
+{
+    this->mode = mode;
+    Logger::Log("Frame pacing mode: " + std::string(GetModeName(mode)));
+    Reset();
+}
+
+void FramePacer::SetTargetRate(double targetRate)
+{
+    this->targetRate = std::max(targetRate, 1.0);
+    Reset();
+}
+
+void FramePacer::Reset()
+{
+    previousFrameCounter = SDL_GetPerformanceCounter();
+    nextFrameCounter = previousFrameCounter;
+}
+
+double FramePacer::GetRate() const
+{
+    return mode == FRAME_PACING_POWER_SAVE ? std::min(targetRate, POWER_SAVE_RATE) : targetRate;
+}
+
+void FramePacer::WaitUntil(Uint64 deadline, bool spin)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    while (now < deadline)
+    {
+        double remaining = static_cast<double>(deadline - now) / frequency;
+        double sleepSeconds = spin ? remaining - spinSeconds : remaining;
+        if (sleepSeconds < 0.001)
+        {
+            if (!spin)
+            {
+                return;
+            }
+            now = SDL_GetPerformanceCounter();
+            continue;
+        }
+
+        Uint32 sleepMs = static_cast<Uint32>(sleepSeconds * 1000.0);
+        SDL_Delay(sleepMs);
+        Uint64 woken = SDL_GetPerformanceCounter();
+
+        // Grow the spin margin right away when a sleep overshoots, shrink it slowly when they get better
+        double overslept = static_cast<double>(woken - now) / frequency - sleepMs / 1000.0;
+        spinSeconds = std::max(overslept * 1.25, spinSeconds * 0.99);
+        spinSeconds = std::min(std::max(spinSeconds, MIN_SPIN_SECONDS), MAX_SPIN_SECONDS);
+        now = woken;
+    }
+}
+
+double FramePacer::WaitForNextFrame()
+{
+    if (mode == FRAME_PACING_FIXED || mode == FRAME_PACING_POWER_SAVE)
+    {
+        Uint64 period = static_cast<Uint64>(frequency / GetRate());
+        nextFrameCounter += period;
+
+        // a frame that ran over a whole period starts a new schedule rather than trying to catch up
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now > nextFrameCounter + period)
+        {
+            nextFrameCounter = now;
+        }
+        WaitUntil(nextFrameCounter, mode == FRAME_PACING_FIXED);
+    }
+
+    Uint64 frameCounter = SDL_GetPerformanceCounter();
+    double frameTime = static_cast<double>(frameCounter - previousFrameCounter) / frequency;
+    previousFrameCounter = frameCounter;
+
+    if (static_cast<int>(frameTimes.size()) < STATS_FRAME_COUNT)
+    {
+        frameTimes.push_back(frameTime);
+    }
+    else
+    {
+        frameTimes[nextFrameTime] = frameTime;
+    }
+    nextFrameTime = (nextFrameTime + 1) % STATS_FRAME_COUNT;
+
+    return frameTime;
+}
+
+FrameStats FramePacer::GetStats() const
+{
+    FrameStats stats;
+    if (frameTimes.empty())
+    {
+        return stats;
+    }
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (auto frameTime : sorted)
+    {
+        sum += frameTime;
+    }
+    double average = sum / sorted.size();
+    double variance = 0.0;
+    for (auto frameTime : sorted)
+    {
+        variance += (frameTime - average) * (frameTime - average);
+    }
+    variance /= sorted.size();
+
+    stats.averageMs = average * 1000.0;
+    stats.minMs = sorted.front() * 1000.0;
+    stats.maxMs = sorted.back() * 1000.0;
+    stats.jitterMs = std::sqrt(variance) * 1000.0;
+    stats.p99Ms = sorted[(sorted.size() - 1) * 99 / 100] * 1000.0;
+    stats.frameCount = sorted.size();
+    return stats;
+}
+
+const char *FramePacer::GetModeName(FramePacingMode mode)
+{
+    switch (mode)
+    {
+    case FRAME_PACING_UNCAPPED:
+        return "uncapped";
+    case FRAME_PACING_VSYNC:
+        return "vsync";
+    case FRAME_PACING_FIXED:
+        return "fixed";
+    case FRAME_PACING_POWER_SAVE:
+        return "power save";
+    }
+    return "unknown";
+}
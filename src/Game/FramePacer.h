@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+enum FramePacingMode
+{
+    FRAME_PACING_UNCAPPED,  // no wait at all
+    FRAME_PACING_VSYNC,     // the present blocks until the display refresh
+    FRAME_PACING_FIXED,     // sleep then spin up to the target rate
+    FRAME_PACING_POWER_SAVE // sleep only, at a lower rate, for idle kiosks
+};
+
+// Frame time statistics over the last frames, in milliseconds
+struct FrameStats
+{
+    double averageMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double jitterMs = 0.0; // standard deviation of the frame time
+    double p99Ms = 0.0;
+    int frameCount = 0;
+};
+
+/*
+FramePacer
+Paces the main loop with the performance counter instead of millisecond SDL_GetTicks and SDL_Delay.
+The wait sleeps while the deadline is far and spins for the last stretch, the spin margin adapts to how much
+SDL_Delay actually oversleeps on this machine. Deadlines advance by a fixed period so the rate doesn't drift.
+*/
+class FramePacer
+{
+private:
+    FramePacingMode mode;
+    double targetRate;
+
+    Uint64 frequency;
+    Uint64 previousFrameCounter = 0;
+    Uint64 nextFrameCounter = 0;
+    double spinSeconds = 0.002;
+
+    static const int STATS_FRAME_COUNT = 240;
+    std::vector<double> frameTimes; // ring buffer of the last frame times in seconds
+    int nextFrameTime = 0;
+
+    double GetRate() const;
+    void WaitUntil(Uint64 deadline, bool spin);
+
+public:
+    FramePacer(FramePacingMode mode = FRAME_PACING_VSYNC, double targetRate = 60.0);
+
+    // vsync is a renderer setting, the game applies UsesVSync to the renderer on the thread that owns it
+    void SetMode(FramePacingMode mode);
+    FramePacingMode GetMode() const { return mode; }
+    bool UsesVSync() const { return mode == FRAME_PACING_VSYNC; }
+    void SetTargetRate(double targetRate);
+    double GetTargetRate() const { return targetRate; }
+
+    // Restarts the timing, e.g. after loading a level, so the wait isn't counted as a frame
+    void Reset();
+
+    // Blocks until the next frame should start and returns the time since the previous one in seconds
+    double WaitForNextFrame();
+
+    FrameStats GetStats() const;
+
+    static const char *GetModeName(FramePacingMode mode);
+};
@@ -23,10 +23,13 @@
 #include "../Systems/RenderTextSystem.h"
 #include "../Systems/RenderHealthUISystem.h"
 #include "../Systems/RenderGuiSystem.h"
+#include "../Systems/CullingSystem.h"
 #include "../Systems/ScriptSystem.h"
+#include "../Systems/ParticleSystem.h"
 #include "../AssetStore/AssetStore.h"
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 int Game::windowWidth;
 int Game::windowHeight;
@@ -36,9 +39,13 @@ int Game::mapHeight;
 Game::Game()
 {
     isRunning = false;
+    framePacer.SetTargetRate(FPS);
     registry = std::make_unique<Registry>();
     assetStore = std::make_unique<AssetStore>();
     eventBus = std::make_unique<EventBus>();
+    threadPool = std::make_unique<ThreadPool>();
+    tileMapRenderer = std::make_unique<TileMapRenderer>();
+    renderThread = std::make_unique<RenderThread>();
     renderColliders = false;
     Logger::Log("Game constructor called");
 }
@@ -50,7 +57,8 @@ Game::~Game()
 
 void Game::Initialize()
 {
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+    // the software renderer needs no video driver, headless runs only start what they use
+    if (SDL_Init(headless ? SDL_INIT_TIMER | SDL_INIT_EVENTS : SDL_INIT_EVERYTHING) != 0)
     {
         Logger::Err("Error initializing SDL");
         return;
@@ -62,10 +70,37 @@ void Game::Initialize()
         return;
     }
 
+    windowWidth = WINDOW_WIDTH;
+    windowHeight = WINDOW_HEIGHT;
+    camera = {0, 0, windowWidth, windowHeight};
+
+    if (headless)
+    {
+        window = nullptr;
+        headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!headlessSurface)
+        {
+            Logger::Err("Error creating headless render surface: " + std::string(SDL_GetError()));
+            return;
+        }
+
+        // software renderers start without vsync
+        rendererVSync = false;
+        framePacer.SetMode(FRAME_PACING_UNCAPPED);
+        if (!renderThread->Start(threadedRendering, [this]()
+                                 { return renderer = SDL_CreateSoftwareRenderer(headlessSurface); }, [this]()
+                                 { inputLatencyTracker.OnPresent(); }))
+        {
+            Logger::Err("Error creating SDL software renderer: " + std::string(SDL_GetError()));
+            return;
+        }
+
+        isRunning = true;
+        return;
+    }
+
     SDL_DisplayMode displayMode;
     SDL_GetCurrentDisplayMode(0, &displayMode);
-    windowWidth = WINDOW_WIDTH;   // displayMode.w;
-    windowHeight = WINDOW_HEIGHT; // displayMode.h;
 
     window = SDL_CreateWindow(NULL, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, SDL_WINDOW_BORDERLESS);
 
@@ -75,9 +110,12 @@ void Game::Initialize()
         return;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-
-    if (!renderer)
+    // the renderer is created with vsync, keep it until a different mode is picked in the debug gui
+    rendererVSync = true;
+    framePacer.SetMode(FRAME_PACING_VSYNC);
+    if (!renderThread->Start(threadedRendering, [this]()
+                             { return renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC); }, [this]()
+                             { inputLatencyTracker.OnPresent(); }))
     {
         Logger::Err("Error creating SDL renderer");
         return;
@@ -89,10 +127,11 @@ void Game::Initialize()
 
     ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
 
-    ImGui_ImplSDLRenderer2_Init(renderer);
-
-    // Initialize camera view with entire screen area
-    camera = {0, 0, windowWidth, windowHeight};
+    // the gui font texture is created up front, on the thread that owns the renderer
+    renderThread->Invoke([](SDL_Renderer *renderer)
+                         {
+        ImGui_ImplSDLRenderer2_Init(renderer);
+        ImGui_ImplSDLRenderer2_CreateDeviceObjects(); });
 
     // SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
 
@@ -104,13 +143,28 @@ void Game::ProcessInput()
     SDL_Event sdlEvent;
     while (SDL_PollEvent(&sdlEvent))
     {
-        ImGui_ImplSDL2_ProcessEvent(&sdlEvent);
+        if (!headless)
+        {
+            ImGui_ImplSDL2_ProcessEvent(&sdlEvent);
+        }
+        inputLatencyTracker.OnEventPolled(sdlEvent);
 
         switch (sdlEvent.type)
         {
         case SDL_QUIT:
             isRunning = false;
             break;
+        case SDL_RENDER_TARGETS_RESET:
+            renderThread->Invoke([this](SDL_Renderer *)
+                                 { tileMapRenderer->Invalidate(false); });
+            break;
+        case SDL_RENDER_DEVICE_RESET:
+            renderThread->Invoke([this](SDL_Renderer *)
+                                 {
+                tileMapRenderer->Invalidate(true);
+                registry->GetSystem<RenderTextSystem>().Clear(); // glyphs are rasterized again as they are drawn
+                registry->GetSystem<RenderHealthUISystem>().Clear(); });
+            break;
         case SDL_KEYDOWN:
             if (sdlEvent.key.keysym.sym == SDLK_ESCAPE)
             {
@@ -121,6 +175,10 @@ void Game::ProcessInput()
             {
                 renderColliders = !renderColliders;
             }
+            if (sdlEvent.key.keysym.sym == SDLK_l)
+            {
+                SetLowLatencyInput(!lowLatencyInput);
+            }
 
             eventBus->EmitEvent<KeyPressedEvent>(sdlEvent.key.keysym.sym);
 
@@ -134,36 +192,55 @@ void Game::Setup()
     // Add the systems that need to be processed
     registry->AddSystem<MovementSystem>();
     registry->AddSystem<RenderSystem>();
+    registry->AddSystem<CullingSystem>();
     registry->AddSystem<AnimationSystem>();
     registry->AddSystem<CollisionSystem>();
     registry->AddSystem<DamageSystem>();
     registry->AddSystem<KeyboardControlSystem>();
     registry->AddSystem<CameraMovementSystem>();
-    registry->AddSystem<ProjectileEmitSystem>();
-    registry->AddSystem<ProjectileLifecycleSystem>();
+    registry->AddSystem<ProjectileEmitSystem>(timerWheel);
+    registry->AddSystem<ProjectileLifecycleSystem>(timerWheel);
     registry->AddSystem<RenderTextSystem>();
     registry->AddSystem<RenderHealthUISystem>();
     registry->AddSystem<RenderGuiSystem>();
     registry->AddSystem<ScriptSystem>();
+    registry->AddSystem<ParticleSystem>();
+
+    // scripts and systems can ask the collision broad phase which entities are near a point
+    registry->SetSpatialQuery(&registry->GetSystem<CollisionSystem>());
 
-    registry->GetSystem<ScriptSystem>().CreateLuaBindings(lua);
+    registry->GetSystem<ScriptSystem>().CreateLuaBindings(lua, registry);
 
     LevelLoader loader;
     lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::os);
-    loader.LoadLevel(lua, registry, assetStore, renderer, 1);
+    // the level's textures are created on the thread that owns the renderer, the game waits for it
+    renderThread->Invoke([this, &loader](SDL_Renderer *renderer)
+                         { loader.LoadLevel(lua, registry, assetStore, tileMapRenderer, renderer, 1); });
+    registry->GetSystem<ProjectileEmitSystem>().CreateProjectilePool(registry);
+
+    // don't count the level loading as simulation time
+    framePacer.Reset();
 }
 
-void Game::Update()
+void Game::Update(double frameTime)
 {
-    int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
-    if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME)
+    // run as many fixed ticks as the frame time covers, the remainder is carried over to the next frame
+    simulationAccumulator = std::min(simulationAccumulator + frameTime, MAX_SIMULATION_TICKS_PER_FRAME * SIMULATION_TIMESTEP);
+    while (simulationAccumulator >= SIMULATION_TIMESTEP)
     {
-        SDL_Delay(timeToWait);
+        FixedUpdate(SIMULATION_TIMESTEP);
+        simulationAccumulator -= SIMULATION_TIMESTEP;
     }
+    interpolationAlpha = simulationAccumulator / SIMULATION_TIMESTEP;
 
-    double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
+    // the camera follows the interpolated position, so it moves every frame and not only on ticks
+    registry->GetSystem<CameraMovementSystem>().Update(camera, interpolationAlpha);
+}
 
-    millisecsPreviousFrame = SDL_GetTicks();
+void Game::FixedUpdate(double deltaTime)
+{
+    simulationTicks++;
+    Uint64 simulationTime = simulationTicks * 1000 / SIMULATION_RATE; // milliseconds
 
     eventBus->Reset();
 
@@ -175,52 +252,148 @@ void Game::Update()
     registry->Update();
 
     registry->GetSystem<MovementSystem>().Update(deltaTime);
-    registry->GetSystem<AnimationSystem>().Update();
-    registry->GetSystem<CollisionSystem>().Update(eventBus);
-    registry->GetSystem<CameraMovementSystem>().Update(camera);
-    registry->GetSystem<ProjectileEmitSystem>().Update(registry);
-    registry->GetSystem<ProjectileLifecycleSystem>().Update();
-    registry->GetSystem<ScriptSystem>().Update(deltaTime, SDL_GetTicks());
+    registry->GetSystem<AnimationSystem>().Update(static_cast<Uint32>(simulationTime));
+    registry->GetSystem<CollisionSystem>().Update(eventBus, threadPool);
+    // emitters fire and projectiles expire as their timers come due
+    timerWheel.Advance(static_cast<Uint32>(simulationTicks)); // the wheel only looks at tick differences, wrapping is fine
+    registry->GetSystem<ParticleSystem>().Update(deltaTime);
+    // scripts get the simulation time, so they behave the same whatever the frame rate
+    registry->GetSystem<ScriptSystem>().Update(deltaTime, static_cast<int>(simulationTime));
 }
 
 void Game::Render()
 {
+    RenderCommandList &commands = renderThread->BeginFrame();
+    commands.Clear({21, 21, 21, 255});
 
-    SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
-    SDL_RenderClear(renderer);
+    if (framePacer.UsesVSync() != rendererVSync)
+    {
+        rendererVSync = framePacer.UsesVSync();
+        commands.Callback([vsync = rendererVSync](SDL_Renderer *renderer)
+                          {
+            if (SDL_RenderSetVSync(renderer, vsync ? 1 : 0) != 0)
+            {
+                Logger::Err("Error setting the renderer vsync: " + std::string(SDL_GetError()));
+            } });
+    }
 
-    // registry->GetSystem<RenderSystem>().Update(renderer, std::make_unique<AssetStore> & assetStore);
-    registry->GetSystem<RenderSystem>().Update(renderer, assetStore, renderColliders, camera);
-    registry->GetSystem<RenderTextSystem>().Update(renderer, assetStore, camera);
-    registry->GetSystem<RenderHealthUISystem>().Update(renderer, assetStore, camera);
+    // the chunks are baked on the render thread, only the camera is copied
+    commands.Callback([this, camera = camera](SDL_Renderer *renderer)
+                      { tileMapRenderer->Render(renderer, assetStore, camera); });
 
-    if (renderColliders)
+    // one culling pass, every render system draws from the same visible set
+    auto &culling = registry->GetSystem<CullingSystem>();
+    culling.Update(camera);
+    registry->GetSystem<RenderSystem>().Update(commands, assetStore, renderColliders, camera, interpolationAlpha, culling);
+    registry->GetSystem<ParticleSystem>().Render(commands, assetStore, camera, interpolationAlpha);
+    registry->GetSystem<RenderTextSystem>().Update(commands, assetStore, camera, culling);
+    registry->GetSystem<RenderHealthUISystem>().Update(commands, assetStore, camera, interpolationAlpha, culling);
+
+    if (renderColliders && !headless)
     {
-        registry->GetSystem<RenderGuiSystem>().Update(renderer, registry);
+        registry->GetSystem<RenderGuiSystem>().Update(commands, registry, framePacer, inputLatencyTracker);
     }
 
-    SDL_RenderPresent(renderer);
+    // presented on the render thread while the next frame is simulated
+    inputLatencyTracker.OnFrameSubmitted();
+    renderThread->Submit();
+
+    frameCount++;
+    if (frameLimit > 0 && frameCount >= frameLimit)
+    {
+        isRunning = false;
+    }
 }
 
 void Game::Run()
 {
     Setup();
+    Uint64 startCounter = SDL_GetPerformanceCounter();
     while (isRunning)
     {
-        ProcessInput();
-        Update();
+        if (!lowLatencyInput)
+        {
+            ProcessInput();
+        }
+
+        double frameTime = framePacer.WaitForNextFrame();
+        if (headless)
+        {
+            frameTime = SIMULATION_TIMESTEP;
+        }
+
+        if (lowLatencyInput)
+        {
+            ProcessInput();
+        }
+
+        Update(frameTime);
         Render();
     }
+
+    if (headless)
+    {
+        renderThread->Flush();
+        double seconds = static_cast<double>(SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency();
+        FrameStats stats = framePacer.GetStats();
+        std::cout << "frames: " << frameCount << "\n"
+                  << "seconds: " << seconds << "\n"
+                  << "average fps: " << (seconds > 0.0 ? frameCount / seconds : 0.0) << "\n"
+                  << "frame ms (last " << stats.frameCount << "): average " << stats.averageMs << ", min " << stats.minMs
+                  << ", max " << stats.maxMs << ", 99th " << stats.p99Ms << "\n"
+                  << "sprite draw calls: " << registry->GetSystem<RenderSystem>().GetDrawCallCount() << "\n"
+                  << "text draw calls: " << registry->GetSystem<RenderTextSystem>().GetDrawCallCount() << "\n"
+                  << "particles: " << registry->GetSystem<ParticleSystem>().GetParticleCount() << std::endl;
+    }
+}
+
+void Game::SetThreadedRendering(bool threadedRendering)
+{
+    this->threadedRendering = threadedRendering;
+}
+
+void Game::SetHeadless(bool headless, int frameLimit)
+{
+    this->headless = headless;
+    this->frameLimit = frameLimit;
+}
+
+void Game::SetLowLatencyInput(bool lowLatencyInput)
+{
+    this->lowLatencyInput = lowLatencyInput;
+    Logger::Log(std::string("Low latency input ") + (lowLatencyInput ? "on" : "off"));
 }
 
 void Game::Destroy()
 {
-    ImGui_ImplSDLRenderer2_Shutdown();
-    ImGui_ImplSDL2_Shutdown();
-    ImGui::DestroyContext();
+    // the gui textures, chunk textures, glyph atlases and health labels belong to the renderer,
+    // they go with it on the render thread
+    renderThread->Stop([this](SDL_Renderer *renderer)
+                       {
+        if (!headless)
+        {
+            ImGui_ImplSDLRenderer2_Shutdown();
+        }
+        tileMapRenderer->Clear();
+        registry->GetSystem<RenderTextSystem>().Clear();
+        registry->GetSystem<RenderHealthUISystem>().Clear();
+        SDL_DestroyRenderer(renderer); });
+    renderer = nullptr;
 
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    if (!headless)
+    {
+        ImGui_ImplSDL2_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    if (window)
+    {
+        SDL_DestroyWindow(window);
+    }
+    if (headlessSurface)
+    {
+        SDL_FreeSurface(headlessSurface);
+    }
     SDL_Quit();
     isRunning = false;
 }
\ No newline at end of file
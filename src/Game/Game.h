@@ -5,10 +5,19 @@
 #include "../ECS/ECS.h"
 #include "../AssetStore/AssetStore.h"
 #include "../EventBus/EventBus.h"
+#include "../Threading/ThreadPool.h"
+#include "FramePacer.h"
+#include "InputLatencyTracker.h"
+#include "TimerWheel.h"
+#include "../Renderer/TileMapRenderer.h"
+#include "../Renderer/RenderThread.h"
 #include <sol/sol.hpp>
 
-const int FPS = 500;
-const int MILLISECS_PER_FRAME = 1000 / FPS;
+const int FPS = 500; // target rate of the fixed frame pacing mode
+// the simulation runs at a fixed rate whatever the frame rate, rendering interpolates between the last two ticks
+const int SIMULATION_RATE = 60;
+const double SIMULATION_TIMESTEP = 1.0 / SIMULATION_RATE;
+const int MAX_SIMULATION_TICKS_PER_FRAME = 8; // after a long hitch the backlog is dropped rather than replayed
 const int TILE_SIZE = 32;
 const int TILE_SCALE = 2;
 const int WINDOW_WIDTH = 1200;
@@ -18,9 +27,28 @@ class Game
 {
 private:
     bool isRunning;
-    int millisecsPreviousFrame = 0;
+    FramePacer framePacer;
+    InputLatencyTracker inputLatencyTracker;
+
+    // Low latency input waits for the frame first and polls the input right before the simulation,
+    // instead of polling it and then sleeping until the frame starts.
+    bool lowLatencyInput = false;
+
+    // Headless runs render the full frame with the software renderer into an offscreen surface,
+    // without a window, vsync or the debug gui, for benchmarks and servers without a display.
+    // Every frame advances the simulation by exactly one tick so runs are repeatable.
+    bool headless = false;
+    int frameLimit = 0; // frames to run before quitting, 0 runs until the game is quit
+    int frameCount = 0;
+    SDL_Surface *headlessSurface = nullptr;
+    double simulationAccumulator = 0.0;
+    Uint64 simulationTicks = 0; // 64 bits, so the simulation time in milliseconds never wraps
+    double interpolationAlpha = 0.0; // how far rendering is between the previous tick and the current one
+    TimerWheel timerWheel{SIMULATION_RATE}; // deadlines in simulation ticks, turned once per tick
     SDL_Window *window;
-    SDL_Renderer *renderer;
+    SDL_Renderer *renderer; // belongs to the render thread, only handed to work that runs there
+    bool threadedRendering = false;
+    bool rendererVSync = false; // what the renderer was last set to, the frame pacer mode can change it
     bool renderColliders = false;
     SDL_Rect camera;
 
@@ -30,15 +58,22 @@ private:
     std::unique_ptr<Registry> registry;
     std::unique_ptr<AssetStore> assetStore;
     std::unique_ptr<EventBus> eventBus; // keeps track of event subscriptions
+    std::unique_ptr<TileMapRenderer> tileMapRenderer;
+    std::unique_ptr<ThreadPool> threadPool; // worker threads shared by the systems that split their work
+    std::unique_ptr<RenderThread> renderThread; // executes the frames the render systems record
 
 public:
     Game();
     ~Game();
     void Initialize();
     void Run();
+    void SetLowLatencyInput(bool lowLatencyInput);
+    void SetHeadless(bool headless, int frameLimit = 0); // before Initialize
+    void SetThreadedRendering(bool threadedRendering);   // before Initialize
     void Setup();
     void ProcessInput();
-    void Update();
+    void Update(double frameTime);
+    void FixedUpdate(double deltaTime);
     void Render();
     void Destroy();
 
@@ -0,0 +1,89 @@
+#include "InputLatencyTracker.h"
+#include <algorithm>
+
+void InputLatencyTracker::OnEventPolled(const SDL_Event &event)
+{
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingEvents.push_back({event.common.timestamp, SDL_GetPerformanceCounter(), 0});
+        break;
+    }
+    }
+}
+
+void InputLatencyTracker::OnFrameSubmitted()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    submittedFrames++;
+    for (auto &event : pendingEvents)
+    {
+        if (event.frame == 0)
+        {
+            event.frame = submittedFrames;
+        }
+    }
+}
+
+void InputLatencyTracker::OnPresent()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    presentedFrames++;
+    if (pendingEvents.empty())
+    {
+        return;
+    }
+
+    Uint32 presentTicks = SDL_GetTicks();
+    Uint64 presentCounter = SDL_GetPerformanceCounter();
+    double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    size_t kept = 0;
+    for (const auto &event : pendingEvents)
+    {
+        // polled after this frame was submitted, it shows in a later one
+        if (event.frame == 0 || event.frame > presentedFrames)
+        {
+            pendingEvents[kept++] = event;
+            continue;
+        }
+
+        Sample sample = {
+            static_cast<double>(presentTicks - event.queuedTicks),
+            (presentCounter - event.polledCounter) * 1000.0 / frequency};
+
+        if (static_cast<int>(samples.size()) < SAMPLE_COUNT)
+        {
+            samples.push_back(sample);
+        }
+        else
+        {
+            samples[nextSample] = sample;
+        }
+        nextSample = (nextSample + 1) % SAMPLE_COUNT;
+    }
+    pendingEvents.resize(kept);
+}
+
+InputLatencyStats InputLatencyTracker::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    InputLatencyStats stats;
+    for (const auto &sample : samples)
+    {
+        stats.averageMs += sample.queueToPresentMs;
+        stats.averagePollToPresentMs += sample.pollToPresentMs;
+        stats.maxMs = std::max(stats.maxMs, sample.queueToPresentMs);
+    }
+    stats.sampleCount = samples.size();
+    if (stats.sampleCount > 0)
+    {
+        stats.averageMs /= stats.sampleCount;
+        stats.averagePollToPresentMs /= stats.sampleCount;
+    }
+    return stats;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <mutex>
+#include <vector>
+
+// Input latency over the last samples, in milliseconds
+struct InputLatencyStats
+{
+    double averageMs = 0.0; // from SDL queueing the event to the present that showed its effect
+    double maxMs = 0.0;
+    double averagePollToPresentMs = 0.0; // from the game reading the event to the present
+    int sampleCount = 0;
+};
+
+/*
+InputLatencyTracker
+Timestamps every input event when it's polled and closes the samples on the present of the first frame
+submitted after it, so the effect of the input sampling order on input-to-present latency can be measured.
+The queue time comes from the event's own millisecond timestamp, the poll time from the performance counter.
+With a render thread the present happens on that thread while the game polls the next frame's input,
+so the tracker is locked.
+*/
+class InputLatencyTracker
+{
+private:
+    struct PendingEvent
+    {
+        Uint32 queuedTicks;
+        Uint64 polledCounter;
+        unsigned int frame; // the frame that shows it, 0 until it's submitted
+    };
+    std::vector<PendingEvent> pendingEvents;
+    unsigned int submittedFrames = 0;
+    unsigned int presentedFrames = 0;
+    mutable std::mutex mutex;
+
+    struct Sample
+    {
+        double queueToPresentMs;
+        double pollToPresentMs;
+    };
+    static const int SAMPLE_COUNT = 120;
+    std::vector<Sample> samples; // ring buffer
+    int nextSample = 0;
+
+public:
+    InputLatencyTracker() = default;
+
+    void OnEventPolled(const SDL_Event &event);
+    void OnFrameSubmitted();
+    void OnPresent();
+
+    InputLatencyStats GetStats() const;
+};
@@ -15,11 +15,66 @@
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/KeyboardControlComponent.h"
 #include "../Components/ProjectileEmmitterComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
 #include "../Components/CameraFollowComponent.h"
 #include "../Components/UILabelComponent.h"
 #include "../Components/HealthComponent.h"
 #include "../Components/ScriptComponent.h"
 
+namespace
+{
+    // maps the layer names used in the level tables to collision layer bits
+    unsigned int getCollisionLayer(const std::string &name)
+    {
+        static const std::unordered_map<std::string, unsigned int> layers = {
+            {"default", COLLISION_LAYER_DEFAULT},
+            {"player", COLLISION_LAYER_PLAYER},
+            {"enemy", COLLISION_LAYER_ENEMY},
+            {"projectile", COLLISION_LAYER_PROJECTILE},
+            {"obstacle", COLLISION_LAYER_OBSTACLE},
+            {"tile", COLLISION_LAYER_TILE},
+            {"all", COLLISION_LAYER_ALL}};
+
+        auto layer = layers.find(name);
+        if (layer == layers.end())
+        {
+            Logger::Err("Unknown collision layer: " + name);
+            return 0;
+        }
+        return layer->second;
+    }
+
+    AnimationLoopMode getAnimationLoopMode(const std::string &name)
+    {
+        if (name == "once")
+        {
+            return ANIMATION_ONCE;
+        }
+        if (name == "ping_pong")
+        {
+            return ANIMATION_PING_PONG;
+        }
+        if (name != "loop")
+        {
+            Logger::Err("Unknown animation loop mode: " + name);
+        }
+        return ANIMATION_LOOP;
+    }
+
+    // numFrames frames of the same size side by side in a row of the sprite sheet, each shown 1000 / speedRate ms
+    AnimationClip makeAnimationClip(int numFrames, int speedRate, int width, int height, int srcRectY, AnimationLoopMode loopMode)
+    {
+        AnimationClip clip;
+        for (int frame = 0; frame < numFrames; frame++)
+        {
+            clip.frames.push_back({frame * width, srcRectY, width, height});
+            clip.durations.push_back(1000 / std::max(speedRate, 1));
+        }
+        clip.loopMode = loopMode;
+        return clip;
+    }
+}
+
 LevelLoader::LevelLoader()
 {
     Logger::Log("LevelLoader constructor called");
@@ -59,7 +114,7 @@ void LevelLoader::parseFile(std::string filename, std::vector<std::vector<int>>
     file.close();
 }
 
-void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry, std::unique_ptr<AssetStore> &assetStore, SDL_Renderer *renderer, int levelNumber)
+void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry, std::unique_ptr<AssetStore> &assetStore, std::unique_ptr<TileMapRenderer> &tileMapRenderer, SDL_Renderer *renderer, int levelNumber)
 {
 
     // This checks the syntax of our script, but it does not execute the script
@@ -104,9 +159,31 @@ void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry
             assetStore->AddFont(assetId, asset["file"], asset["font_size"]);
             Logger::Log("A new font asset was added to the asset store, id: " + assetId);
         }
+        if (assetType == "animation")
+        {
+            AnimationClip clip = makeAnimationClip(
+                asset["num_frames"], asset["speed_rate"].get_or(1),
+                asset["width"], asset["height"], asset["src_rect_y"].get_or(0),
+                getAnimationLoopMode(asset["loop"].get_or(std::string("loop"))));
+
+            // optional per frame durations in milliseconds
+            sol::optional<sol::table> durations = asset["durations"];
+            if (durations != sol::nullopt)
+            {
+                for (size_t frame = 0; frame < clip.durations.size(); frame++)
+                {
+                    clip.durations[frame] = durations.value()[frame + 1].get_or(static_cast<int>(clip.durations[frame]));
+                }
+            }
+            assetStore->AddAnimationClip(assetId, clip);
+            Logger::Log("A new animation asset was added to the asset store, id: " + assetId);
+        }
         i++;
     }
 
+    // the level textures are drawn from a few shared atlas pages instead of one texture each
+    assetStore->BuildAtlases(renderer);
+
     ////////////////////////////////////////////////////////////////////////////
     // Read the level tilemap information
     ////////////////////////////////////////////////////////////////////////////
@@ -124,23 +201,8 @@ void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry
     int mapNumCols = tilemap[0].size();
     int mapNumRows = tilemap.size();
 
-    //  create entities for each tile in the map
-    for (int i = 0; i < mapNumRows; i++)
-    {
-        for (int j = 0; j < mapNumCols; j++)
-        {
-            int val = tilemap[i][j];
-
-            //  get the x and y position of the tile in the tilemap to use as the source rect
-            int srcX = (val % 10) * TILE_SIZE;
-            int srcY = (val / 10) * TILE_SIZE;
-
-            Entity tile = registry->CreateEntity();
-            tile.AddComponent<TransformComponent>(glm::vec2(j * TILE_SIZE * TILE_SCALE, i * TILE_SIZE * TILE_SCALE), glm::vec2(TILE_SCALE, TILE_SCALE), 0.0, false);
-            tile.AddComponent<SpriteComponent>(mapTextureAssetId, TILE_SIZE, TILE_SIZE, 0, false, srcX, srcY);
-            tile.Group("tiles");
-        }
-    }
+    // the tiles aren't entities, they are baked into a few chunk textures drawn under everything else
+    tileMapRenderer->Load(tilemap, mapTextureAssetId, TILE_SIZE, TILE_SCALE, renderer, assetStore);
     Game::mapWidth = mapNumCols * TILE_SIZE * mapScale;
     Game::mapHeight = mapNumRows * TILE_SIZE * mapScale;
 
@@ -222,10 +284,34 @@ void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry
             if (animation != sol::nullopt)
             {
                 sol::table animationTable = animation.value();
-                int numFrames = animationTable["num_frames"];
-                int animationSpeed = animationTable["speed_rate"];
-                bool isLoop = animationTable["is_loop"].get_or(true);
-                newEntity.AddComponent<AnimationComponent>(numFrames, animationSpeed, isLoop);
+                sol::optional<std::string> clipId = animationTable["clip"];
+                if (clipId != sol::nullopt)
+                {
+                    const AnimationClip *clip = assetStore->GetAnimationClip(clipId.value());
+                    if (!clip)
+                    {
+                        Logger::Err("Unknown animation clip: " + clipId.value());
+                    }
+                    newEntity.AddComponent<AnimationComponent>(clip ? clip->frames.size() : 1, 1, true, clip);
+                }
+                else if (newEntity.HasComponent<SpriteComponent>())
+                {
+                    int numFrames = animationTable["num_frames"];
+                    int animationSpeed = animationTable["speed_rate"];
+                    bool isLoop = animationTable["is_loop"].get_or(true);
+
+                    // the frames are worked out once and shared by every entity with the same sprite and animation
+                    const auto &spriteComponent = newEntity.GetComponent<SpriteComponent>();
+                    std::string uniformClipId = spriteComponent.assetId + "#" + std::to_string(spriteComponent.width) + "x" + std::to_string(spriteComponent.height) +
+                                                "+" + std::to_string(spriteComponent.srcRect.y) + "#" + std::to_string(numFrames) + "@" + std::to_string(animationSpeed) + (isLoop ? "" : "#once");
+                    const AnimationClip *clip = assetStore->GetAnimationClip(uniformClipId);
+                    if (!clip)
+                    {
+                        assetStore->AddAnimationClip(uniformClipId, makeAnimationClip(numFrames, animationSpeed, spriteComponent.width, spriteComponent.height, spriteComponent.srcRect.y, isLoop ? ANIMATION_LOOP : ANIMATION_ONCE));
+                        clip = assetStore->GetAnimationClip(uniformClipId);
+                    }
+                    newEntity.AddComponent<AnimationComponent>(numFrames, animationSpeed, isLoop, clip);
+                }
             }
 
             // Box Collider
@@ -238,7 +324,46 @@ void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry
                 int offsetX = boxColliderTable["offset"]["x"].get_or(0);
                 int offsetY = boxColliderTable["offset"]["y"].get_or(0);
                 glm::vec2 offset = {offsetX, offsetY};
-                newEntity.AddComponent<BoxColliderComponent>(width, height, offset);
+                // obstacles and entities with nothing to move them default to static colliders
+                sol::optional<sol::table> updateScript = entity["components"]["on_update_script"];
+                bool isObstacle = group != sol::nullopt && group.value() == "obstacles";
+                bool canMove = rigidBody != sol::nullopt || updateScript != sol::nullopt;
+                bool isStatic = boxColliderTable["is_static"].get_or(isObstacle || !canMove);
+
+                // the layer defaults from the tag or group, and an empty collides_with list means collide with everything
+                unsigned int layer = COLLISION_LAYER_DEFAULT;
+                if (tag != sol::nullopt && tag.value() == "player")
+                {
+                    layer = COLLISION_LAYER_PLAYER;
+                }
+                else if (group != sol::nullopt && group.value() == "enemies")
+                {
+                    layer = COLLISION_LAYER_ENEMY;
+                }
+                else if (isObstacle)
+                {
+                    layer = COLLISION_LAYER_OBSTACLE;
+                }
+                sol::optional<std::string> layerName = boxColliderTable["layer"];
+                if (layerName != sol::nullopt)
+                {
+                    layer = getCollisionLayer(layerName.value());
+                }
+
+                unsigned int collisionMask = COLLISION_LAYER_ALL;
+                sol::optional<sol::table> collidesWith = boxColliderTable["collides_with"];
+                if (collidesWith != sol::nullopt)
+                {
+                    collisionMask = 0;
+                    for (auto &layerEntry : collidesWith.value())
+                    {
+                        collisionMask |= getCollisionLayer(layerEntry.second.as<std::string>());
+                    }
+                }
+
+                bool isBullet = boxColliderTable["is_bullet"].get_or(false);
+
+                newEntity.AddComponent<BoxColliderComponent>(width, height, offset, isStatic, layer, collisionMask, isBullet);
             }
 
             // Health
@@ -265,6 +390,39 @@ void LevelLoader::LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry
                 newEntity.AddComponent<ProjectileEmitterComponent>(projectileVelocity, frequency, projectileDuration, isFriendly, hitPercentageDamage);
             }
 
+            // Particle Emitter
+            sol::optional<sol::table> particleEmitter = entity["components"]["particle_emitter"];
+            if (particleEmitter != sol::nullopt)
+            {
+                sol::table particleEmitterTable = particleEmitter.value();
+                ParticleEmitterComponent emitter(
+                    particleEmitterTable["texture_asset_id"],
+                    particleEmitterTable["width"],
+                    particleEmitterTable["height"],
+                    particleEmitterTable["num_frames"].get_or(1),
+                    particleEmitterTable["rate"].get_or(0.0f),
+                    particleEmitterTable["life"]["min"].get_or(1000),
+                    particleEmitterTable["life"]["max"].get_or(1000),
+                    particleEmitterTable["speed"]["min"].get_or(0.0f),
+                    particleEmitterTable["speed"]["max"].get_or(0.0f));
+                emitter.isAnimated = particleEmitterTable["animated"].get_or(true);
+                emitter.burst = particleEmitterTable["burst"].get_or(0);
+                emitter.duration = particleEmitterTable["duration"].get_or(0);
+                emitter.offset = glm::vec2(particleEmitterTable["offset"]["x"].get_or(0.0), particleEmitterTable["offset"]["y"].get_or(0.0));
+                emitter.direction = particleEmitterTable["direction"].get_or(0.0f);
+                emitter.spread = particleEmitterTable["spread"].get_or(360.0f);
+                emitter.acceleration = glm::vec2(particleEmitterTable["acceleration"]["x"].get_or(0.0), particleEmitterTable["acceleration"]["y"].get_or(0.0));
+                emitter.scale = particleEmitterTable["scale"].get_or(1.0f);
+                emitter.color = {
+                    static_cast<Uint8>(particleEmitterTable["color"]["r"].get_or(255)),
+                    static_cast<Uint8>(particleEmitterTable["color"]["g"].get_or(255)),
+                    static_cast<Uint8>(particleEmitterTable["color"]["b"].get_or(255)),
+                    static_cast<Uint8>(particleEmitterTable["color"]["a"].get_or(255))};
+                emitter.isFading = particleEmitterTable["fade"].get_or(true);
+
+                newEntity.AddComponent<ParticleEmitterComponent>(emitter);
+            }
+
             // CameraFollow
             sol::optional<sol::table> cameraFollow = entity["components"]["camera_follow"];
             if (cameraFollow != sol::nullopt)
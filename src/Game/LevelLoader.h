@@ -2,6 +2,7 @@
 
 #include "../ECS/ECS.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Renderer/TileMapRenderer.h"
 #include <SDL2/SDL.h>
 #include <memory>
 #include <sol/sol.hpp>
@@ -12,5 +13,5 @@ public:
     LevelLoader();
     ~LevelLoader();
     void parseFile(std::string filename, std::vector<std::vector<int>> &tilemap);
-    void LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry, std::unique_ptr<AssetStore> &assetStore, SDL_Renderer *renderer, int levelNumber);
+    void LoadLevel(sol::state &lua, std::unique_ptr<Registry> &registry, std::unique_ptr<AssetStore> &assetStore, std::unique_ptr<TileMapRenderer> &tileMapRenderer, SDL_Renderer *renderer, int levelNumber);
 };
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+// Refers to a timer scheduled on a TimerWheel, stays safe to cancel after the timer fired or its slot was reused
+struct TimerHandle
+{
+    int index = -1;
+    unsigned int generation = 0;
+};
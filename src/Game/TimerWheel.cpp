@@ -0,0 +1,166 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(int ticksPerSecond)
+    : ticksPerSecond(ticksPerSecond)
+{
+}
+
+TimerHandle TimerWheel::Schedule(Uint32 delay, std::function<void()> callback)
+{
+    return Add(delay, 0, std::move(callback), nullptr);
+}
+
+TimerHandle TimerWheel::ScheduleRepeating(Uint32 period, std::function<void()> callback)
+{
+    return Add(period, std::max<Uint32>(period, 1), std::move(callback), nullptr);
+}
+
+TimerHandle TimerWheel::ScheduleKill(Uint32 delay, Entity entity)
+{
+    return Add(delay, 0, nullptr, &entity);
+}
+
+TimerHandle TimerWheel::Add(Uint32 delay, Uint32 period, std::function<void()> callback, Entity *entityToKill)
+{
+    int index;
+    if (!freeTimers.empty())
+    {
+        index = freeTimers.back();
+        freeTimers.pop_back();
+    }
+    else
+    {
+        index = timers.size();
+        timers.push_back(Timer{0, 0, 0, false, nullptr, -1, nullptr});
+    }
+
+    Timer &timer = timers[index];
+    timer.deadline = now + std::max<Uint32>(delay, 1);
+    timer.period = period;
+    timer.isActive = true;
+    timer.callback = std::move(callback);
+    timer.entityToKill = entityToKill ? entityToKill->GetId() : -1;
+    timer.registry = entityToKill ? entityToKill->registry : nullptr;
+    activeTimerCount++;
+
+    Insert({index, timer.generation});
+    return {index, timer.generation};
+}
+
+void TimerWheel::Insert(SlotEntry entry)
+{
+    Uint32 deadline = timers[entry.index].deadline;
+    Uint32 delay = deadline - now;
+
+    // deadlines beyond the coarsest level wait in its last slot and are placed again when it comes round
+    if (delay > MAX_DELAY)
+    {
+        deadline = now + MAX_DELAY;
+        delay = MAX_DELAY;
+    }
+
+    int level = 0;
+    while (level < LEVEL_COUNT - 1 && delay >= (1u << ((level + 1) * SLOT_BITS)))
+    {
+        level++;
+    }
+    int slot = (deadline >> (level * SLOT_BITS)) & (SLOT_COUNT - 1);
+    slots[level][slot].push_back(entry);
+}
+
+void TimerWheel::Release(int index)
+{
+    Timer &timer = timers[index];
+    timer.generation++;
+    timer.isActive = false;
+    timer.callback = nullptr;
+    freeTimers.push_back(index);
+    activeTimerCount--;
+}
+
+void TimerWheel::Cancel(TimerHandle &handle)
+{
+    if (handle.index >= 0 && handle.index < static_cast<int>(timers.size()) &&
+        timers[handle.index].isActive && timers[handle.index].generation == handle.generation)
+    {
+        Release(handle.index);
+    }
+    handle = TimerHandle();
+}
+
+void TimerWheel::Fire(SlotEntry entry)
+{
+    Timer &timer = timers[entry.index];
+    if (timer.registry)
+    {
+        Entity entity(timer.entityToKill);
+        entity.registry = timer.registry;
+        entity.Kill();
+        Release(entry.index);
+        return;
+    }
+
+    // taken out of the timer while it runs, cancelling its own timer would destroy it otherwise
+    std::function<void()> callback = std::move(timer.callback);
+    callback();
+    if (!timer.isActive || timer.generation != entry.generation)
+    {
+        return;
+    }
+    if (timer.period > 0)
+    {
+        timer.callback = std::move(callback);
+        timer.deadline += timer.period;
+        Insert(entry);
+        return;
+    }
+    Release(entry.index);
+}
+
+void TimerWheel::Advance(Uint32 tick)
+{
+    while (now != tick)
+    {
+        now++;
+
+        // move the timers of the coarse slots that came round down a level, coarsest first, so a timer
+        // can drop through several levels in one tick
+        int level = 0;
+        while (level < LEVEL_COUNT - 1 && ((now >> ((level + 1) * SLOT_BITS)) << ((level + 1) * SLOT_BITS)) == now)
+        {
+            level++;
+        }
+        for (; level > 0; level--)
+        {
+            int slot = (now >> (level * SLOT_BITS)) & (SLOT_COUNT - 1);
+            dueEntries.swap(slots[level][slot]);
+            for (const auto &entry : dueEntries)
+            {
+                const Timer &timer = timers[entry.index];
+                if (timer.isActive && timer.generation == entry.generation)
+                {
+                    Insert(entry);
+                }
+            }
+            dueEntries.clear();
+        }
+
+        // callbacks can add timers to this slot's next round, so the entries due now are taken out first
+        dueEntries.swap(slots[0][now & (SLOT_COUNT - 1)]);
+        for (const auto &entry : dueEntries)
+        {
+            const Timer &timer = timers[entry.index];
+            if (timer.isActive && timer.generation == entry.generation)
+            {
+                Fire(entry);
+            }
+        }
+        dueEntries.clear();
+    }
+}
+
+Uint32 TimerWheel::MillisecondsToTicks(int milliseconds) const
+{
+    return (static_cast<Uint32>(std::max(milliseconds, 0)) * ticksPerSecond + 999) / 1000;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "../ECS/ECS.h"
+#include "TimerHandle.h"
+
+/*
+TimerWheel
+Deadlines counted in simulation ticks, kept in a hierarchical timing wheel: 4 levels of 64 slots, each level 64
+times coarser than the one below. A timer sits in the slot of its deadline on the finest level that reaches it,
+and when the wheel turns past a coarse slot its timers are moved down, so every tick only touches the slots that
+come due. The cost of a tick is the number of timers expiring or moving down, not the number of timers.
+Cancelling is lazy: it bumps the generation of the timer, the entries left in the slots are dropped when reached.
+Timers can be scheduled and cancelled from inside a callback.
+*/
+class TimerWheel
+{
+private:
+    static constexpr int LEVEL_COUNT = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOT_COUNT = 1 << SLOT_BITS;
+    static constexpr Uint32 MAX_DELAY = (1u << (LEVEL_COUNT * SLOT_BITS)) - 1;
+
+    struct Timer
+    {
+        Uint32 deadline;
+        Uint32 period; // ticks between repeats, 0 for a timer that fires once
+        unsigned int generation;
+        bool isActive;
+        std::function<void()> callback;
+        // kill timers have no callback and queue the entity for kill on the registry
+        EntityId entityToKill;
+        Registry *registry;
+    };
+
+    struct SlotEntry
+    {
+        int index;
+        unsigned int generation;
+    };
+
+    std::deque<Timer> timers; // a deque so a timer doesn't move while its callback schedules more timers
+    std::vector<int> freeTimers;
+    std::vector<SlotEntry> slots[LEVEL_COUNT][SLOT_COUNT];
+    std::vector<SlotEntry> dueEntries;
+    Uint32 now = 0;
+    int ticksPerSecond;
+    int activeTimerCount = 0;
+
+    TimerHandle Add(Uint32 delay, Uint32 period, std::function<void()> callback, Entity *entityToKill);
+    void Insert(SlotEntry entry);
+    void Release(int index);
+    void Fire(SlotEntry entry);
+
+public:
+    TimerWheel(int ticksPerSecond);
+
+    // Runs callback after delay ticks, at the earliest on the next tick
+    TimerHandle Schedule(Uint32 delay, std::function<void()> callback);
+
+    // Runs callback every period ticks, the first time after period ticks
+    TimerHandle ScheduleRepeating(Uint32 period, std::function<void()> callback);
+
+    // Queues the entity for kill after delay ticks
+    TimerHandle ScheduleKill(Uint32 delay, Entity entity);
+
+    void Cancel(TimerHandle &handle);
+
+    // Turns the wheel up to the given tick, firing the timers that come due in deadline order
+    void Advance(Uint32 tick);
+
+    // Ticks covering the given milliseconds, rounded up
+    Uint32 MillisecondsToTicks(int milliseconds) const;
+
+    Uint32 GetTick() const { return now; }
+    int GetActiveTimerCount() const { return activeTimerCount; }
+};
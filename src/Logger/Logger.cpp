@@ -2,6 +2,7 @@
 #include <iostream>
 #include <ctime>
 #include <string>
+#include <mutex>
 
 #define GREEN "\033[32m"
 #define RED "\033[31m"
@@ -15,6 +16,9 @@ std::vector<LogEntry> Logger::messages;
 
 namespace
 {
+    // the render thread logs too
+    std::mutex logMutex;
+
     void formatTime(tm *ltm, std::string &monthStr, std::string &hourStr, std::string &minStr, std::string &secStr)
     {
 
@@ -57,6 +61,7 @@ void Logger::Log(const std::string &message)
     LogEntry entry;
     entry.type = LOG_INFO;
 
+    std::lock_guard<std::mutex> lock(logMutex);
     time_t now = time(0);
     tm *ltm = localtime(&now);
     formatTime(ltm, monthStr, hourStr, minStr, secStr);
@@ -73,6 +78,7 @@ void Logger::Err(const std::string &message)
     LogEntry entry;
     entry.type = LOG_ERROR;
 
+    std::lock_guard<std::mutex> lock(logMutex);
     time_t now = time(0);
     tm *ltm = localtime(&now);
     formatTime(ltm, monthStr, hourStr, minStr, secStr);
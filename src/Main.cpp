@@ -1,12 +1,42 @@
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
 #include "./Game/Game.h"
 #include <sol/sol.hpp>
 
+// --headless renders offscreen without a window, --frames N quits after N frames,
+// --render-thread draws and presents on a thread of its own while the next frame is simulated
 int main(int argc, char *argv[])
 {
 
     Game game;
 
+    bool headless = false;
+    int frameLimit = 0;
+    bool threadedRendering = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            headless = true;
+        }
+        else if (std::strcmp(argv[i], "--render-thread") == 0)
+        {
+            threadedRendering = true;
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frameLimit = std::atoi(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--headless] [--frames N] [--render-thread]" << std::endl;
+            return 1;
+        }
+    }
+    game.SetHeadless(headless, frameLimit);
+    game.SetThreadedRendering(threadedRendering);
+
     game.Initialize();
     game.Run();
     game.Destroy();
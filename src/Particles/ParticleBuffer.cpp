@@ -0,0 +1,184 @@
+#include "ParticleBuffer.h"
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PARTICLE_BUFFER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Copies the ring of an attribute into a bigger array, unwrapped so it starts at the oldest particle
+    template <typename T>
+    void growAttribute(std::vector<T> &attribute, int head, int count, int capacity)
+    {
+        std::vector<T> grown(capacity);
+        int firstRun = std::min(count, static_cast<int>(attribute.size()) - head);
+        std::copy(attribute.begin() + head, attribute.begin() + head + firstRun, grown.begin());
+        std::copy(attribute.begin(), attribute.begin() + (count - firstRun), grown.begin() + firstRun);
+        attribute.swap(grown);
+    }
+}
+
+void ParticleBuffer::Grow()
+{
+    int newCapacity = capacity == 0 ? INITIAL_CAPACITY : capacity * 2;
+    growAttribute(positionX, head, count, newCapacity);
+    growAttribute(positionY, head, count, newCapacity);
+    growAttribute(velocityX, head, count, newCapacity);
+    growAttribute(velocityY, head, count, newCapacity);
+    growAttribute(accelerationX, head, count, newCapacity);
+    growAttribute(accelerationY, head, count, newCapacity);
+    growAttribute(life, head, count, newCapacity);
+    growAttribute(inverseLifetime, head, count, newCapacity);
+    growAttribute(color, head, count, newCapacity);
+    growAttribute(frame, head, count, newCapacity);
+    capacity = newCapacity;
+    head = 0;
+}
+
+int ParticleBuffer::Emit()
+{
+    if (count == capacity && capacity < MAX_CAPACITY)
+    {
+        Grow();
+    }
+    if (count == capacity)
+    {
+        head = (head + 1) & (capacity - 1);
+        count--;
+    }
+    int slot = GetSlot(count);
+    count++;
+    return slot;
+}
+
+void ParticleBuffer::Update(float deltaTime)
+{
+    // the live particles are at most two runs of the arrays, before and after the wrap
+    int end = head + count;
+    IntegrateParticles(*this, head, std::min(end, capacity), deltaTime);
+    if (end > capacity)
+    {
+        IntegrateParticles(*this, 0, end - capacity, deltaTime);
+    }
+
+    while (count > 0 && life[head] <= 0.0f)
+    {
+        head = (head + 1) & (capacity - 1);
+        count--;
+    }
+}
+
+void ParticleBuffer::Clear()
+{
+    head = 0;
+    count = 0;
+}
+
+namespace
+{
+    typedef void (*IntegrateKernel)(ParticleBuffer &particles, int begin, int end, float deltaTime);
+
+    void integrateScalar(ParticleBuffer &particles, int begin, int end, float deltaTime)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            particles.velocityX[i] += particles.accelerationX[i] * deltaTime;
+            particles.velocityY[i] += particles.accelerationY[i] * deltaTime;
+            particles.positionX[i] += particles.velocityX[i] * deltaTime;
+            particles.positionY[i] += particles.velocityY[i] * deltaTime;
+            particles.life[i] -= deltaTime;
+        }
+    }
+
+#ifdef PARTICLE_BUFFER_X86
+    // no fused multiply add, so every kernel rounds like the scalar one and the particles move the same on any CPU
+    __attribute__((target("avx2"))) void integrateAVX2(ParticleBuffer &particles, int begin, int end, float deltaTime)
+    {
+        const __m256 step = _mm256_set1_ps(deltaTime);
+        float *positionX = particles.positionX.data();
+        float *positionY = particles.positionY.data();
+        float *velocityX = particles.velocityX.data();
+        float *velocityY = particles.velocityY.data();
+        const float *accelerationX = particles.accelerationX.data();
+        const float *accelerationY = particles.accelerationY.data();
+        float *life = particles.life.data();
+
+        int i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 newVelocityX = _mm256_add_ps(_mm256_loadu_ps(velocityX + i), _mm256_mul_ps(_mm256_loadu_ps(accelerationX + i), step));
+            __m256 newVelocityY = _mm256_add_ps(_mm256_loadu_ps(velocityY + i), _mm256_mul_ps(_mm256_loadu_ps(accelerationY + i), step));
+            _mm256_storeu_ps(velocityX + i, newVelocityX);
+            _mm256_storeu_ps(velocityY + i, newVelocityY);
+            _mm256_storeu_ps(positionX + i, _mm256_add_ps(_mm256_loadu_ps(positionX + i), _mm256_mul_ps(newVelocityX, step)));
+            _mm256_storeu_ps(positionY + i, _mm256_add_ps(_mm256_loadu_ps(positionY + i), _mm256_mul_ps(newVelocityY, step)));
+            _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), step));
+        }
+
+        integrateScalar(particles, i, end, deltaTime);
+    }
+
+    __attribute__((target("avx512f"))) void integrateAVX512(ParticleBuffer &particles, int begin, int end, float deltaTime)
+    {
+        const __m512 step = _mm512_set1_ps(deltaTime);
+        float *positionX = particles.positionX.data();
+        float *positionY = particles.positionY.data();
+        float *velocityX = particles.velocityX.data();
+        float *velocityY = particles.velocityY.data();
+        const float *accelerationX = particles.accelerationX.data();
+        const float *accelerationY = particles.accelerationY.data();
+        float *life = particles.life.data();
+
+        int i = begin;
+        for (; i + 16 <= end; i += 16)
+        {
+            __m512 newVelocityX = _mm512_add_ps(_mm512_loadu_ps(velocityX + i), _mm512_mul_ps(_mm512_loadu_ps(accelerationX + i), step));
+            __m512 newVelocityY = _mm512_add_ps(_mm512_loadu_ps(velocityY + i), _mm512_mul_ps(_mm512_loadu_ps(accelerationY + i), step));
+            _mm512_storeu_ps(velocityX + i, newVelocityX);
+            _mm512_storeu_ps(velocityY + i, newVelocityY);
+            _mm512_storeu_ps(positionX + i, _mm512_add_ps(_mm512_loadu_ps(positionX + i), _mm512_mul_ps(newVelocityX, step)));
+            _mm512_storeu_ps(positionY + i, _mm512_add_ps(_mm512_loadu_ps(positionY + i), _mm512_mul_ps(newVelocityY, step)));
+            _mm512_storeu_ps(life + i, _mm512_sub_ps(_mm512_loadu_ps(life + i), step));
+        }
+
+        integrateScalar(particles, i, end, deltaTime);
+    }
+#endif
+
+    IntegrateKernel selectKernel(const char *&name)
+    {
+#ifdef PARTICLE_BUFFER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            name = "avx512";
+            return integrateAVX512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            name = "avx2";
+            return integrateAVX2;
+        }
+#endif
+        name = "scalar";
+        return integrateScalar;
+    }
+
+    const char *kernelName = "";
+    const IntegrateKernel kernel = selectKernel(kernelName);
+}
+
+void IntegrateParticles(ParticleBuffer &particles, int begin, int end, float deltaTime)
+{
+    if (end > begin)
+    {
+        kernel(particles, begin, end, deltaTime);
+    }
+}
+
+const char *GetParticleKernelName()
+{
+    return kernelName;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ParticleBuffer
+Particles stored as a structure of arrays in a ring buffer, so the update kernel streams through each attribute and
+handles 8 or 16 particles per instruction. New particles go after the newest one and the oldest are retired from the
+front once their life is over. Particles that die out of order stay in place with no life left until they reach the
+front, drawing skips them. The buffer starts small and doubles when it is full, up to MAX_CAPACITY; past that a new
+particle replaces the oldest one.
+*/
+class ParticleBuffer
+{
+public:
+    static constexpr int INITIAL_CAPACITY = 256;
+    static constexpr int MAX_CAPACITY = 1 << 17;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> accelerationX;
+    std::vector<float> accelerationY;
+    std::vector<float> life;            // seconds left
+    std::vector<float> inverseLifetime; // 1 / the seconds the particle was emitted with, to get how far it is through its life
+    std::vector<SDL_Color> color;
+    std::vector<uint8_t> frame;
+
+    // The slot of a new particle, its attributes are for the caller to set
+    int Emit();
+
+    // Moves the particles forward by deltaTime seconds and retires the dead ones at the front
+    void Update(float deltaTime);
+
+    void Clear();
+
+    // The slot of the i-th particle from the oldest one
+    int GetSlot(int i) const { return (head + i) & (capacity - 1); }
+
+    // Particles between the oldest and the newest one, including the dead ones in between
+    int GetCount() const { return count; }
+
+    int GetCapacity() const { return capacity; }
+
+private:
+    int capacity = 0; // always a power of two, so slots wrap with a mask
+    int head = 0;
+    int count = 0;
+
+    // Doubles the capacity, the particles are moved so the oldest one is in the first slot
+    void Grow();
+};
+
+// Integrates particles[begin, end): velocity += acceleration * deltaTime, position += velocity * deltaTime, life -= deltaTime.
+// The widest kernel the CPU supports (AVX-512, AVX2 or scalar) is picked during static initialisation.
+void IntegrateParticles(ParticleBuffer &particles, int begin, int end, float deltaTime);
+
+// Name of the kernel picked at runtime, for logging
+const char *GetParticleKernelName();
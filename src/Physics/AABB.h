@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+/*
+AABB
+Axis aligned bounding box in world space, used by the collision broad phase.
+Edges are inclusive so that touching boxes count as overlapping, the same rule CollisionSystem has always used.
+*/
+struct AABB
+{
+    glm::vec2 min;
+    glm::vec2 max;
+
+    AABB(glm::vec2 min = glm::vec2(0), glm::vec2 max = glm::vec2(0))
+    {
+        this->min = min;
+        this->max = max;
+    }
+
+    bool Overlaps(const AABB &other) const
+    {
+        return max.x >= other.min.x && other.max.x >= min.x &&
+               max.y >= other.min.y && other.max.y >= min.y;
+    }
+
+    bool Contains(const AABB &other) const
+    {
+        return min.x <= other.min.x && min.y <= other.min.y &&
+               other.max.x <= max.x && other.max.y <= max.y;
+    }
+
+    float GetPerimeter() const
+    {
+        return 2.0f * ((max.x - min.x) + (max.y - min.y));
+    }
+
+    AABB Union(const AABB &other) const
+    {
+        return AABB(glm::min(min, other.min), glm::max(max, other.max));
+    }
+
+    AABB Expand(float margin) const
+    {
+        return AABB(min - glm::vec2(margin), max + glm::vec2(margin));
+    }
+
+    // Slab test of the segment from + t * (to - from), t in [0, 1].
+    // Returns true on a hit and writes the entry fraction, which is 0 when the segment starts inside the box.
+    bool RayCast(const glm::vec2 &from, const glm::vec2 &to, float &fraction) const
+    {
+        glm::vec2 direction = to - from;
+        float tMin = 0.0f;
+        float tMax = 1.0f;
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (direction[axis] == 0.0f)
+            {
+                if (from[axis] < min[axis] || from[axis] > max[axis])
+                {
+                    return false;
+                }
+                continue;
+            }
+            float inverse = 1.0f / direction[axis];
+            float t1 = (min[axis] - from[axis]) * inverse;
+            float t2 = (max[axis] - from[axis]) * inverse;
+            if (t1 > t2)
+            {
+                std::swap(t1, t2);
+            }
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax)
+            {
+                return false;
+            }
+        }
+        fraction = tMin;
+        return true;
+    }
+
+    // Swept test of this box moving by displacement against other, which doesn't move.
+    // Returns true on a hit and writes the time of impact as a fraction of the displacement, 0 when they already overlap.
+    bool SweepCast(const glm::vec2 &displacement, const AABB &other, float &fraction) const
+    {
+        // grow the other box by this one's size and cast this box's min corner against it
+        AABB expanded(other.min - (max - min), other.max);
+        return expanded.RayCast(min, min + displacement, fraction);
+    }
+};
@@ -0,0 +1,111 @@
+#include "AABBBatch.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define AABB_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    typedef void (*OverlapKernel)(const AABB &box, const AABBBatch &boxes, int begin, int end, uint32_t *hitMask);
+
+    // Tests boxes[first, end), writing the result of box i to bit i - begin
+    void overlapRange(const AABB &box, const AABBBatch &boxes, int begin, int first, int end, uint32_t *hitMask)
+    {
+        for (int i = first; i < end; i++)
+        {
+            bool hit = box.max.x >= boxes.minX[i] && boxes.maxX[i] >= box.min.x &&
+                       box.max.y >= boxes.minY[i] && boxes.maxY[i] >= box.min.y;
+            int bit = i - begin;
+            hitMask[bit >> 5] |= static_cast<uint32_t>(hit) << (bit & 31);
+        }
+    }
+
+    void overlapScalar(const AABB &box, const AABBBatch &boxes, int begin, int end, uint32_t *hitMask)
+    {
+        overlapRange(box, boxes, begin, begin, end, hitMask);
+    }
+
+#ifdef AABB_BATCH_X86
+    __attribute__((target("avx2"))) void overlapAVX2(const AABB &box, const AABBBatch &boxes, int begin, int end, uint32_t *hitMask)
+    {
+        const __m256 boxMinX = _mm256_set1_ps(box.min.x);
+        const __m256 boxMinY = _mm256_set1_ps(box.min.y);
+        const __m256 boxMaxX = _mm256_set1_ps(box.max.x);
+        const __m256 boxMaxY = _mm256_set1_ps(box.max.y);
+
+        int i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 hit = _mm256_and_ps(_mm256_cmp_ps(boxMaxX, _mm256_loadu_ps(&boxes.minX[i]), _CMP_GE_OQ),
+                                       _mm256_cmp_ps(_mm256_loadu_ps(&boxes.maxX[i]), boxMinX, _CMP_GE_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(boxMaxY, _mm256_loadu_ps(&boxes.minY[i]), _CMP_GE_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_loadu_ps(&boxes.maxY[i]), boxMinY, _CMP_GE_OQ));
+
+            // blocks of 8 start at multiples of 8 from begin, so they never straddle two mask words
+            int bit = i - begin;
+            hitMask[bit >> 5] |= static_cast<uint32_t>(_mm256_movemask_ps(hit)) << (bit & 31);
+        }
+
+        overlapRange(box, boxes, begin, i, end, hitMask);
+    }
+
+    __attribute__((target("avx512f"))) void overlapAVX512(const AABB &box, const AABBBatch &boxes, int begin, int end, uint32_t *hitMask)
+    {
+        const __m512 boxMinX = _mm512_set1_ps(box.min.x);
+        const __m512 boxMinY = _mm512_set1_ps(box.min.y);
+        const __m512 boxMaxX = _mm512_set1_ps(box.max.x);
+        const __m512 boxMaxY = _mm512_set1_ps(box.max.y);
+
+        int i = begin;
+        for (; i + 16 <= end; i += 16)
+        {
+            __mmask16 hit = _mm512_cmp_ps_mask(boxMaxX, _mm512_loadu_ps(&boxes.minX[i]), _CMP_GE_OQ);
+            hit = _mm512_mask_cmp_ps_mask(hit, _mm512_loadu_ps(&boxes.maxX[i]), boxMinX, _CMP_GE_OQ);
+            hit = _mm512_mask_cmp_ps_mask(hit, boxMaxY, _mm512_loadu_ps(&boxes.minY[i]), _CMP_GE_OQ);
+            hit = _mm512_mask_cmp_ps_mask(hit, _mm512_loadu_ps(&boxes.maxY[i]), boxMinY, _CMP_GE_OQ);
+
+            int bit = i - begin;
+            hitMask[bit >> 5] |= static_cast<uint32_t>(hit) << (bit & 31);
+        }
+
+        overlapRange(box, boxes, begin, i, end, hitMask);
+    }
+#endif
+
+    OverlapKernel selectKernel(const char *&name)
+    {
+#ifdef AABB_BATCH_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            name = "avx512";
+            return overlapAVX512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            name = "avx2";
+            return overlapAVX2;
+        }
+#endif
+        name = "scalar";
+        return overlapScalar;
+    }
+
+    const char *kernelName = "";
+    const OverlapKernel kernel = selectKernel(kernelName);
+}
+
+void OverlapOneVsMany(const AABB &box, const AABBBatch &boxes, int begin, int end, std::vector<uint32_t> &hitMask)
+{
+    hitMask.assign((std::max(end - begin, 0) + 31) / 32, 0);
+    if (end > begin)
+    {
+        kernel(box, boxes, begin, end, hitMask.data());
+    }
+}
+
+const char *GetOverlapKernelName()
+{
+    return kernelName;
+}
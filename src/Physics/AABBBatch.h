@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "AABB.h"
+
+/*
+AABBBatch
+Boxes stored as a structure of arrays, so the overlap kernel can load 8 or 16 of them with a single instruction.
+*/
+struct AABBBatch
+{
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+
+    void Clear()
+    {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+    }
+
+    void Add(const AABB &box)
+    {
+        minX.push_back(box.min.x);
+        minY.push_back(box.min.y);
+        maxX.push_back(box.max.x);
+        maxY.push_back(box.max.y);
+    }
+
+    void Set(int index, const AABB &box)
+    {
+        minX[index] = box.min.x;
+        minY[index] = box.min.y;
+        maxX[index] = box.max.x;
+        maxY[index] = box.max.y;
+    }
+
+    // Moves the last box into the given slot and drops the last slot
+    void RemoveSwap(int index)
+    {
+        minX[index] = minX.back();
+        minY[index] = minY.back();
+        maxX[index] = maxX.back();
+        maxY[index] = maxY.back();
+        minX.pop_back();
+        minY.pop_back();
+        maxX.pop_back();
+        maxY.pop_back();
+    }
+
+    int GetSize() const { return minX.size(); }
+};
+
+// Tests one box against boxes[begin, end) using the same inclusive rule as AABB::Overlaps.
+// hitMask is resized to hold one bit per tested box: bit i of word i / 32 is set when boxes[begin + i] overlaps.
+// The widest kernel the CPU supports (AVX-512, AVX2 or scalar) is picked the first time this is called.
+void OverlapOneVsMany(const AABB &box, const AABBBatch &boxes, int begin, int end, std::vector<uint32_t> &hitMask);
+
+// Name of the kernel picked at runtime, for logging
+const char *GetOverlapKernelName();
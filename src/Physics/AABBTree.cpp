@@ -0,0 +1,464 @@
+#include "AABBTree.h"
+#include <cmath>
+
+AABBTree::AABBTree(float margin)
+{
+    this->margin = margin;
+}
+
+int AABBTree::AllocateNode()
+{
+    if (freeList == NULL_NODE)
+    {
+        nodes.emplace_back();
+        nodes.back().parent = NULL_NODE;
+        freeList = nodes.size() - 1;
+    }
+
+    int node = freeList;
+    freeList = nodes[node].parent;
+    nodes[node].parent = NULL_NODE;
+    nodes[node].child1 = NULL_NODE;
+    nodes[node].child2 = NULL_NODE;
+    nodes[node].height = 0;
+    nodes[node].entity = -1;
+    return node;
+}
+
+void AABBTree::FreeNode(int node)
+{
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+void AABBTree::AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter)
+{
+    int leaf = AllocateNode();
+    nodes[leaf].box = box.Expand(margin);
+    nodes[leaf].entity = entity;
+    InsertLeaf(leaf);
+    proxies[entity] = {leaf, box, filter};
+}
+
+void AABBTree::RemoveProxy(EntityId entity)
+{
+    auto it = proxies.find(entity);
+    if (it == proxies.end())
+    {
+        return;
+    }
+    RemoveLeaf(it->second.leaf);
+    FreeNode(it->second.leaf);
+    proxies.erase(it);
+}
+
+void AABBTree::MoveProxy(EntityId entity, const AABB &box)
+{
+    auto it = proxies.find(entity);
+    if (it == proxies.end())
+    {
+        return;
+    }
+    Proxy &proxy = it->second;
+    proxy.box = box;
+
+    // still inside the fat box, the tree doesn't need to change
+    if (nodes[proxy.leaf].box.Contains(box))
+    {
+        return;
+    }
+
+    RemoveLeaf(proxy.leaf);
+    nodes[proxy.leaf].box = box.Expand(margin);
+    InsertLeaf(proxy.leaf);
+}
+
+const AABB &AABBTree::GetFatBox(EntityId entity) const
+{
+    return nodes[proxies.at(entity).leaf].box;
+}
+
+void AABBTree::InsertLeaf(int leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down to the sibling where adding the leaf grows the total perimeter the least
+    AABB leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].IsLeaf())
+    {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float perimeter = nodes[index].box.GetPerimeter();
+        float combinedPerimeter = nodes[index].box.Union(leafBox).GetPerimeter();
+
+        // cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedPerimeter;
+
+        // minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+        auto descendCost = [&](int child)
+        {
+            float childCost = nodes[child].box.Union(leafBox).GetPerimeter();
+            if (!nodes[child].IsLeaf())
+            {
+                childCost -= nodes[child].box.GetPerimeter();
+            }
+            return childCost + inheritanceCost;
+        };
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    // Create a new parent for the sibling and the leaf
+    int oldParent = nodes[sibling].parent;
+    int newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = leafBox.Union(nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (nodes[oldParent].child1 == sibling)
+        {
+            nodes[oldParent].child1 = newParent;
+        }
+        else
+        {
+            nodes[oldParent].child2 = newParent;
+        }
+    }
+    else
+    {
+        root = newParent;
+    }
+
+    // Walk back up fixing heights and boxes
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].box = nodes[child1].box.Union(nodes[child2].box);
+
+        index = nodes[index].parent;
+    }
+}
+
+void AABBTree::RemoveLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NULL_NODE)
+    {
+        // Destroy the parent and connect the sibling to the grand parent
+        if (nodes[grandParent].child1 == parent)
+        {
+            nodes[grandParent].child1 = sibling;
+        }
+        else
+        {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+
+        int index = grandParent;
+        while (index != NULL_NODE)
+        {
+            index = Balance(index);
+
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+            nodes[index].box = nodes[child1].box.Union(nodes[child2].box);
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+            index = nodes[index].parent;
+        }
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+    }
+}
+
+// If the node's subtrees differ in height by more than one, rotate the taller child up.
+// Returns the index of the node that is now at this position in the tree.
+int AABBTree::Balance(int iA)
+{
+    Node &A = nodes[iA];
+    if (A.IsLeaf() || A.height < 2)
+    {
+        return iA;
+    }
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node &B = nodes[iB];
+    Node &C = nodes[iC];
+
+    int balance = C.height - B.height;
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node &F = nodes[iF];
+        Node &G = nodes[iG];
+
+        // Swap A and C
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        // A's old parent should point to C
+        if (C.parent != NULL_NODE)
+        {
+            if (nodes[C.parent].child1 == iA)
+            {
+                nodes[C.parent].child1 = iC;
+            }
+            else
+            {
+                nodes[C.parent].child2 = iC;
+            }
+        }
+        else
+        {
+            root = iC;
+        }
+
+        // Rotate
+        if (F.height > G.height)
+        {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.box = B.box.Union(G.box);
+            C.box = A.box.Union(F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        }
+        else
+        {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.box = B.box.Union(F.box);
+            C.box = A.box.Union(G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node &D = nodes[iD];
+        Node &E = nodes[iE];
+
+        // Swap A and B
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        // A's old parent should point to B
+        if (B.parent != NULL_NODE)
+        {
+            if (nodes[B.parent].child1 == iA)
+            {
+                nodes[B.parent].child1 = iB;
+            }
+            else
+            {
+                nodes[B.parent].child2 = iB;
+            }
+        }
+        else
+        {
+            root = iB;
+        }
+
+        // Rotate
+        if (D.height > E.height)
+        {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.box = C.box.Union(E.box);
+            B.box = A.box.Union(D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        }
+        else
+        {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.box = C.box.Union(D.box);
+            B.box = A.box.Union(E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void AABBTree::FindPairs(std::vector<BroadPhasePair> &pairs)
+{
+    // Every pair is found from both of its leaves, keep the one found from the lower entity id
+    for (auto &proxy : proxies)
+    {
+        EntityId entity = proxy.first;
+        const AABB &box = proxy.second.box;
+        const CollisionFilter &filter = proxy.second.filter;
+
+        stack.clear();
+        if (root != NULL_NODE)
+        {
+            stack.push_back(root);
+        }
+        while (!stack.empty())
+        {
+            int index = stack.back();
+            stack.pop_back();
+
+            const Node &node = nodes[index];
+            if (!node.box.Overlaps(box))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                if (entity >= node.entity)
+                {
+                    continue;
+                }
+                const Proxy &other = proxies.at(node.entity);
+                if (filter.CollidesWith(other.filter) && other.box.Overlaps(box))
+                {
+                    pairs.push_back({entity, node.entity});
+                }
+            }
+            else
+            {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+}
+
+void AABBTree::QueryAABB(const AABB &region, std::vector<EntityId> &results) const
+{
+    stack.clear();
+    if (root != NULL_NODE)
+    {
+        stack.push_back(root);
+    }
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node &node = nodes[index];
+        if (!node.box.Overlaps(region))
+        {
+            continue;
+        }
+        if (node.IsLeaf())
+        {
+            if (proxies.at(node.entity).box.Overlaps(region))
+            {
+                results.push_back(node.entity);
+            }
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void AABBTree::RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const
+{
+    size_t firstHit = hits.size();
+
+    stack.clear();
+    if (root != NULL_NODE)
+    {
+        stack.push_back(root);
+    }
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node &node = nodes[index];
+        float fraction;
+        if (!node.box.RayCast(from, to, fraction))
+        {
+            continue;
+        }
+        if (node.IsLeaf())
+        {
+            if (proxies.at(node.entity).box.RayCast(from, to, fraction))
+            {
+                hits.push_back({node.entity, fraction, from + (to - from) * fraction});
+            }
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+
+    std::sort(hits.begin() + firstHit, hits.end(), [](const RayCastHit &a, const RayCastHit &b)
+              { return a.fraction < b.fraction; });
+}
+
+int AABBTree::GetHeight() const
+{
+    return root == NULL_NODE ? 0 : nodes[root].height;
+}
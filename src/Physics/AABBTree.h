@@ -0,0 +1,72 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "BroadPhase.h"
+
+/*
+AABBTree
+Dynamic bounding volume hierarchy. Every leaf stores a "fat" box, the collider box grown by a margin,
+so an entity that moves a little stays inside its leaf and the tree is only touched when it leaves it.
+Inserts pick the sibling with the cheapest perimeter growth and the tree is kept balanced with rotations.
+Works well with colliders of very different sizes, from 4x4 projectiles up to carriers and runways.
+*/
+class AABBTree : public IBroadPhase
+{
+private:
+    static const int NULL_NODE = -1;
+
+    struct Node
+    {
+        AABB box;
+        EntityId entity;
+        int parent; // next free node while the node is in the free list
+        int child1;
+        int child2;
+        int height; // 0 for leaves, -1 for free nodes
+
+        bool IsLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    struct Proxy
+    {
+        int leaf;
+        AABB box; // the exact box, used for leaf tests so queries return exact results
+        CollisionFilter filter;
+    };
+
+    float margin;
+    int root = NULL_NODE;
+    std::vector<Node> nodes;
+    int freeList = NULL_NODE;
+    std::unordered_map<EntityId, Proxy> proxies;
+
+    // traversal stack, kept as a member so queries don't allocate
+    mutable std::vector<int> stack;
+
+    int AllocateNode();
+    void FreeNode(int node);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+
+public:
+    AABBTree(float margin = 4.0f);
+
+    void AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter) override;
+    void RemoveProxy(EntityId entity) override;
+    void MoveProxy(EntityId entity, const AABB &box) override;
+    void FindPairs(std::vector<BroadPhasePair> &pairs) override;
+
+    // Appends every entity whose box overlaps the region
+    void QueryAABB(const AABB &region, std::vector<EntityId> &results) const override;
+
+    // Appends every entity hit by the segment, sorted from the closest hit to the furthest
+    void RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const override;
+
+    // The fat box of the entity's leaf, a box inside it can be given to MoveProxy without changing the tree
+    const AABB &GetFatBox(EntityId entity) const;
+
+    int GetHeight() const;
+    int GetProxyCount() const { return proxies.size(); }
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "AABB.h"
+#include "../ECS/ECS.h"
+
+/*
+CollisionFilter
+A proxy only pairs with proxies whose layer is in its mask and whose mask contains its layer.
+Filtered pairs are rejected by the broad phase before any box test.
+*/
+struct CollisionFilter
+{
+    unsigned int layer;
+    unsigned int mask;
+
+    CollisionFilter(unsigned int layer = 0xFFFFFFFF, unsigned int mask = 0xFFFFFFFF)
+    {
+        this->layer = layer;
+        this->mask = mask;
+    }
+
+    bool CollidesWith(const CollisionFilter &other) const
+    {
+        return (layer & other.mask) != 0 && (other.layer & mask) != 0;
+    }
+};
+
+// A pair of entities whose boxes may overlap, always stored with a < b
+struct BroadPhasePair
+{
+    EntityId a;
+    EntityId b;
+};
+
+// Builds a key that is the same no matter the order the two entities are given in
+inline uint64_t GetPairKey(EntityId a, EntityId b)
+{
+    if (a > b)
+    {
+        std::swap(a, b);
+    }
+    return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+}
+
+struct RayCastHit
+{
+    EntityId entity;
+    float fraction; // 0 at the start of the ray, 1 at the end
+    glm::vec2 point;
+};
+
+inline BroadPhasePair GetPairFromKey(uint64_t key)
+{
+    return {static_cast<EntityId>(key >> 32), static_cast<EntityId>(key & 0xFFFFFFFF)};
+}
+
+/*
+IBroadPhase
+The broad phase keeps one proxy box per collider and cheaply finds the pairs that might be touching,
+so the narrow phase only has to run the exact test on those.
+*/
+class IBroadPhase
+{
+public:
+    virtual ~IBroadPhase() = default;
+
+    virtual void AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter) = 0;
+    virtual void RemoveProxy(EntityId entity) = 0;
+    virtual void MoveProxy(EntityId entity, const AABB &box) = 0;
+
+    // Appends the candidate pairs for this frame, each pair is reported once
+    virtual void FindPairs(std::vector<BroadPhasePair> &pairs) = 0;
+
+    // Appends the entities whose proxy box overlaps the region
+    virtual void QueryAABB(const AABB &region, std::vector<EntityId> &results) const = 0;
+
+    // Appends every entity whose proxy box is hit by the segment, in no particular order
+    virtual void RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const = 0;
+};
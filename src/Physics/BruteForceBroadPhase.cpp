@@ -0,0 +1,108 @@
+#include "BruteForceBroadPhase.h"
+
+void BruteForceBroadPhase::AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter)
+{
+    indexPerEntity[entity] = entities.size();
+    entities.push_back(entity);
+    filters.push_back(filter);
+    boxes.Add(box);
+}
+
+void BruteForceBroadPhase::RemoveProxy(EntityId entity)
+{
+    auto it = indexPerEntity.find(entity);
+    if (it == indexPerEntity.end())
+    {
+        return;
+    }
+
+    // swap the last proxy into the free slot so the arrays stay packed
+    int index = it->second;
+    indexPerEntity.erase(it);
+    if (index != static_cast<int>(entities.size()) - 1)
+    {
+        indexPerEntity[entities.back()] = index;
+    }
+    entities[index] = entities.back();
+    filters[index] = filters.back();
+    entities.pop_back();
+    filters.pop_back();
+    boxes.RemoveSwap(index);
+}
+
+void BruteForceBroadPhase::MoveProxy(EntityId entity, const AABB &box)
+{
+    auto it = indexPerEntity.find(entity);
+    if (it != indexPerEntity.end())
+    {
+        boxes.Set(it->second, box);
+    }
+}
+
+void BruteForceBroadPhase::FindPairs(std::vector<BroadPhasePair> &pairs)
+{
+    int count = entities.size();
+    laterLayers.assign(count + 1, 0);
+    laterMasks.assign(count + 1, 0);
+    for (int i = count - 1; i >= 0; i--)
+    {
+        laterLayers[i] = laterLayers[i + 1] | filters[i].layer;
+        laterMasks[i] = laterMasks[i + 1] | filters[i].mask;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        // nothing after this proxy can pair with it, so the boxes aren't tested at all
+        if ((filters[i].layer & laterMasks[i + 1]) == 0 || (filters[i].mask & laterLayers[i + 1]) == 0)
+        {
+            continue;
+        }
+
+        AABB box(glm::vec2(boxes.minX[i], boxes.minY[i]), glm::vec2(boxes.maxX[i], boxes.maxY[i]));
+        OverlapOneVsMany(box, boxes, i + 1, count, hitMask);
+
+        for (size_t word = 0; word < hitMask.size(); word++)
+        {
+            uint32_t bits = hitMask[word];
+            while (bits != 0)
+            {
+                int j = i + 1 + word * 32 + __builtin_ctz(bits);
+                bits &= bits - 1;
+                // the exact filter test only runs on the few overlapping boxes, building a mask of the compatible
+                // slots for every proxy would cost as much as the batched box test itself
+                if (filters[i].CollidesWith(filters[j]))
+                {
+                    pairs.push_back(GetPairFromKey(GetPairKey(entities[i], entities[j])));
+                }
+            }
+        }
+    }
+}
+
+void BruteForceBroadPhase::QueryAABB(const AABB &region, std::vector<EntityId> &results) const
+{
+    OverlapOneVsMany(region, boxes, 0, entities.size(), hitMask);
+
+    for (size_t word = 0; word < hitMask.size(); word++)
+    {
+        uint32_t bits = hitMask[word];
+        while (bits != 0)
+        {
+            results.push_back(entities[word * 32 + __builtin_ctz(bits)]);
+            bits &= bits - 1;
+        }
+    }
+}
+
+void BruteForceBroadPhase::RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const
+{
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        AABB box(glm::vec2(boxes.minX[i], boxes.minY[i]), glm::vec2(boxes.maxX[i], boxes.maxY[i]));
+        float fraction;
+        if (box.RayCast(from, to, fraction))
+        {
+            hits.push_back({entities[i], fraction, from + (to - from) * fraction});
+        }
+    }
+}
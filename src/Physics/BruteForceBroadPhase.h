@@ -0,0 +1,36 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "BroadPhase.h"
+#include "AABBBatch.h"
+
+/*
+BruteForceBroadPhase
+Tests every proxy against every other one, which is what CollisionSystem originally did.
+The boxes are kept in an AABBBatch so each proxy is tested against 8 or 16 others per instruction,
+which makes this a fair choice for small scenes and a reference for the other broad phases.
+*/
+class BruteForceBroadPhase : public IBroadPhase
+{
+private:
+    std::vector<EntityId> entities;
+    std::vector<CollisionFilter> filters;
+    AABBBatch boxes;
+    std::unordered_map<EntityId, int> indexPerEntity;
+    mutable std::vector<uint32_t> hitMask;
+
+    // layers and masks of the proxies from each index to the end, or-ed together
+    std::vector<unsigned int> laterLayers;
+    std::vector<unsigned int> laterMasks;
+
+public:
+    BruteForceBroadPhase() = default;
+
+    void AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter) override;
+    void RemoveProxy(EntityId entity) override;
+    void MoveProxy(EntityId entity, const AABB &box) override;
+    void FindPairs(std::vector<BroadPhasePair> &pairs) override;
+    void QueryAABB(const AABB &region, std::vector<EntityId> &results) const override;
+    void RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const override;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "AABB.h"
+#include "../ECS/ECS.h"
+
+/*
+ISpatialQuery
+Answers "which colliders are here" for the registry, CollisionSystem implements it on top of its broad phase.
+Results are appended to the caller's buffer and only colliders whose layer is in the mask are returned.
+*/
+class ISpatialQuery
+{
+public:
+    virtual ~ISpatialQuery() = default;
+
+    // Entities whose collider overlaps the region, sorted by id
+    virtual void QueryAABB(const AABB &region, unsigned int mask, std::vector<Entity> &results) = 0;
+
+    // Entities whose collider touches the circle, sorted by id
+    virtual void QueryRadius(const glm::vec2 &center, float radius, unsigned int mask, std::vector<Entity> &results) = 0;
+
+    // Entities whose collider is hit by the segment, sorted from the closest hit to the furthest
+    virtual void RayCast(const glm::vec2 &from, const glm::vec2 &to, unsigned int mask, std::vector<EntityHit> &hits) = 0;
+};
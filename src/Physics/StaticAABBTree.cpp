@@ -0,0 +1,116 @@
+#include "StaticAABBTree.h"
+
+void StaticAABBTree::Clear()
+{
+    nodes.clear();
+    items.clear();
+}
+
+void StaticAABBTree::Build(const std::vector<Collider> &colliders)
+{
+    Clear();
+    for (auto &collider : colliders)
+    {
+        items.push_back({collider.entity, collider.box, collider.filter, (collider.box.min + collider.box.max) * 0.5f});
+    }
+    if (items.empty())
+    {
+        return;
+    }
+    nodes.reserve(items.size() * 2 - 1);
+    BuildNode(0, items.size());
+}
+
+void StaticAABBTree::BuildNode(int begin, int end)
+{
+    int index = nodes.size();
+    nodes.emplace_back();
+
+    AABB box = items[begin].box;
+    for (int i = begin + 1; i < end; i++)
+    {
+        box = box.Union(items[i].box);
+    }
+    nodes[index].box = box;
+
+    if (end - begin == 1)
+    {
+        nodes[index].entity = items[begin].entity;
+        nodes[index].filter = items[begin].filter;
+        nodes[index].escape = nodes.size();
+        return;
+    }
+
+    // Split on the median of the longest axis, the children follow their parent in the array
+    int axis = (box.max.x - box.min.x) >= (box.max.y - box.min.y) ? 0 : 1;
+    int middle = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end, [axis](const Item &a, const Item &b)
+                     { return a.center[axis] < b.center[axis]; });
+
+    BuildNode(begin, middle);
+    BuildNode(middle, end);
+
+    nodes[index].entity = -1;
+    nodes[index].escape = nodes.size();
+}
+
+void StaticAABBTree::QueryAABB(const AABB &region, std::vector<EntityId> &results) const
+{
+    int index = 0;
+    int count = nodes.size();
+    while (index < count)
+    {
+        const Node &node = nodes[index];
+        if (!node.box.Overlaps(region))
+        {
+            index = node.escape;
+            continue;
+        }
+        if (node.entity >= 0)
+        {
+            results.push_back(node.entity);
+        }
+        index++;
+    }
+}
+
+void StaticAABBTree::QueryAABB(const AABB &region, const CollisionFilter &filter, std::vector<EntityId> &results) const
+{
+    int index = 0;
+    int count = nodes.size();
+    while (index < count)
+    {
+        const Node &node = nodes[index];
+        if (!node.box.Overlaps(region))
+        {
+            index = node.escape;
+            continue;
+        }
+        if (node.entity >= 0 && filter.CollidesWith(node.filter))
+        {
+            results.push_back(node.entity);
+        }
+        index++;
+    }
+}
+
+void StaticAABBTree::RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const
+{
+    int index = 0;
+    int count = nodes.size();
+    while (index < count)
+    {
+        const Node &node = nodes[index];
+        float fraction;
+        if (!node.box.RayCast(from, to, fraction))
+        {
+            index = node.escape;
+            continue;
+        }
+        if (node.entity >= 0)
+        {
+            hits.push_back({node.entity, fraction, from + (to - from) * fraction});
+        }
+        index++;
+    }
+}
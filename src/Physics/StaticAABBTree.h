@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include "AABB.h"
+#include "AABBTree.h"
+
+/*
+StaticAABBTree
+Immutable bounding volume hierarchy for colliders that never move.
+It is built once from the full set of boxes by splitting on the median of the longest axis,
+and the nodes are packed in depth first order so a query is a single forward walk over an array.
+*/
+class StaticAABBTree
+{
+private:
+    struct Node
+    {
+        AABB box;
+        EntityId entity; // -1 for inner nodes
+        CollisionFilter filter;
+        int escape;      // index of the next node to visit when this subtree is skipped
+    };
+
+    struct Item
+    {
+        EntityId entity;
+        AABB box;
+        CollisionFilter filter;
+        glm::vec2 center;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Item> items;
+
+    void BuildNode(int begin, int end);
+
+public:
+    StaticAABBTree() = default;
+
+    struct Collider
+    {
+        EntityId entity;
+        AABB box;
+        CollisionFilter filter;
+    };
+
+    void Build(const std::vector<Collider> &colliders);
+    void Clear();
+    bool IsEmpty() const { return nodes.empty(); }
+
+    // Appends every entity whose box overlaps the region
+    void QueryAABB(const AABB &region, std::vector<EntityId> &results) const;
+
+    // Same as above, but skips colliders the filter doesn't collide with
+    void QueryAABB(const AABB &region, const CollisionFilter &filter, std::vector<EntityId> &results) const;
+
+    // Appends every entity hit by the segment, unsorted
+    void RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const;
+};
@@ -0,0 +1,182 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+void SweepAndPrune::AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter)
+{
+    int proxy;
+    if (freeProxies.size() > 0)
+    {
+        proxy = freeProxies.back();
+        freeProxies.pop_back();
+    }
+    else
+    {
+        proxy = proxies.size();
+        proxies.emplace_back();
+    }
+    proxies[proxy].entity = entity;
+    proxies[proxy].box = box;
+    proxies[proxy].filter = filter;
+    proxies[proxy].isAlive = true;
+    proxies[proxy].pairs.clear();
+    proxyPerEntity[entity] = proxy;
+
+    // New endpoints go at the end of the arrays, the next sort moves them into place and reports their overlaps
+    for (int axis = 0; axis < 2; axis++)
+    {
+        endpoints[axis].push_back({box.min[axis], proxy, true});
+        endpoints[axis].push_back({box.max[axis], proxy, false});
+    }
+}
+
+void SweepAndPrune::RemoveProxy(EntityId entity)
+{
+    auto it = proxyPerEntity.find(entity);
+    if (it == proxyPerEntity.end())
+    {
+        return;
+    }
+    int proxy = it->second;
+    proxyPerEntity.erase(it);
+
+    for (auto key : proxies[proxy].pairs)
+    {
+        overlappingPairs.erase(key);
+        BroadPhasePair entities = GetPairFromKey(key);
+        RemovePairKey(proxyPerEntity.at(entities.a == entity ? entities.b : entities.a), key);
+    }
+    proxies[proxy].pairs.clear();
+
+    // the slot can only be reused once the sort has dropped its endpoints
+    proxies[proxy].isAlive = false;
+    deadProxies.push_back(proxy);
+}
+
+void SweepAndPrune::MoveProxy(EntityId entity, const AABB &box)
+{
+    auto it = proxyPerEntity.find(entity);
+    if (it != proxyPerEntity.end())
+    {
+        proxies[it->second].box = box;
+    }
+}
+
+void SweepAndPrune::AddPair(int proxyA, int proxyB)
+{
+    if (proxyA == proxyB || !proxies[proxyA].filter.CollidesWith(proxies[proxyB].filter) || !proxies[proxyA].box.Overlaps(proxies[proxyB].box))
+    {
+        return;
+    }
+    uint64_t key = GetPairKey(proxies[proxyA].entity, proxies[proxyB].entity);
+    if (overlappingPairs.insert(key).second)
+    {
+        proxies[proxyA].pairs.push_back(key);
+        proxies[proxyB].pairs.push_back(key);
+    }
+}
+
+void SweepAndPrune::RemovePair(int proxyA, int proxyB)
+{
+    uint64_t key = GetPairKey(proxies[proxyA].entity, proxies[proxyB].entity);
+    if (overlappingPairs.erase(key) > 0)
+    {
+        RemovePairKey(proxyA, key);
+        RemovePairKey(proxyB, key);
+    }
+}
+
+void SweepAndPrune::RemovePairKey(int proxy, uint64_t key)
+{
+    auto &pairs = proxies[proxy].pairs;
+    auto it = std::find(pairs.begin(), pairs.end(), key);
+    if (it != pairs.end())
+    {
+        *it = pairs.back();
+        pairs.pop_back();
+    }
+}
+
+// On equal values a min endpoint sorts before a max endpoint, so touching intervals count as overlapping
+bool SweepAndPrune::Precedes(const Endpoint &a, const Endpoint &b)
+{
+    return a.value < b.value || (a.value == b.value && a.isMin && !b.isMin);
+}
+
+// Insertion sort, an endpoint moving left past another one is the only moment an overlap can begin or end
+void SweepAndPrune::SortAxis(int axis)
+{
+    // the endpoints of dead proxies are dropped while the values are refreshed, the order of the rest is kept
+    auto &axisEndpoints = endpoints[axis];
+    size_t kept = 0;
+    for (size_t i = 0; i < axisEndpoints.size(); i++)
+    {
+        Endpoint endpoint = axisEndpoints[i];
+        const Proxy &proxy = proxies[endpoint.proxy];
+        if (!proxy.isAlive)
+        {
+            continue;
+        }
+        endpoint.value = endpoint.isMin ? proxy.box.min[axis] : proxy.box.max[axis];
+        axisEndpoints[kept++] = endpoint;
+    }
+    axisEndpoints.resize(kept);
+
+    for (size_t i = 1; i < axisEndpoints.size(); i++)
+    {
+        Endpoint moving = axisEndpoints[i];
+        size_t j = i;
+        while (j > 0 && Precedes(moving, axisEndpoints[j - 1]))
+        {
+            const Endpoint &passed = axisEndpoints[j - 1];
+            if (moving.isMin && !passed.isMin)
+            {
+                AddPair(moving.proxy, passed.proxy);
+            }
+            else if (!moving.isMin && passed.isMin)
+            {
+                RemovePair(moving.proxy, passed.proxy);
+            }
+            axisEndpoints[j] = passed;
+            j--;
+        }
+        axisEndpoints[j] = moving;
+    }
+}
+
+void SweepAndPrune::FindPairs(std::vector<BroadPhasePair> &pairs)
+{
+    SortAxis(0);
+    SortAxis(1);
+
+    freeProxies.insert(freeProxies.end(), deadProxies.begin(), deadProxies.end());
+    deadProxies.clear();
+
+    for (auto key : overlappingPairs)
+    {
+        pairs.push_back(GetPairFromKey(key));
+    }
+}
+
+void SweepAndPrune::QueryAABB(const AABB &region, std::vector<EntityId> &results) const
+{
+    // the sorted endpoints would let this skip the proxies left of the region, but queries are rare next to FindPairs
+    for (const auto &entry : proxyPerEntity)
+    {
+        if (proxies[entry.second].box.Overlaps(region))
+        {
+            results.push_back(entry.first);
+        }
+    }
+}
+
+void SweepAndPrune::RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const
+{
+    for (const auto &entry : proxyPerEntity)
+    {
+        float fraction;
+        if (proxies[entry.second].box.RayCast(from, to, fraction))
+        {
+            hits.push_back({entry.first, fraction, from + (to - from) * fraction});
+        }
+    }
+}
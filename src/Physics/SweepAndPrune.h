@@ -0,0 +1,61 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "BroadPhase.h"
+
+/*
+SweepAndPrune
+Keeps the interval endpoints of every proxy sorted on both axes between frames.
+Because most entities barely move, the arrays are almost sorted already and insertion sort repairs them in close to O(n).
+Every swap between a min and a max endpoint is an overlap starting or ending, so the set of overlapping pairs
+is updated incrementally instead of being searched for again every frame.
+Removing a proxy only marks it dead: its endpoints are dropped by the next sort, which walks the arrays anyway,
+and every proxy keeps the keys of its overlapping pairs so only those are erased.
+*/
+class SweepAndPrune : public IBroadPhase
+{
+private:
+    struct Endpoint
+    {
+        float value;
+        int proxy;
+        bool isMin;
+    };
+
+    struct Proxy
+    {
+        EntityId entity;
+        AABB box;
+        CollisionFilter filter;
+        bool isAlive;
+        std::vector<uint64_t> pairs; // keys of the overlapping pairs the proxy is part of
+    };
+
+    // endpoints[0] is sorted on x, endpoints[1] on y
+    std::vector<Endpoint> endpoints[2];
+
+    std::vector<Proxy> proxies;
+    std::vector<int> freeProxies;
+    std::vector<int> deadProxies; // removed, but their endpoints are still in the arrays until the next sort
+    std::unordered_map<EntityId, int> proxyPerEntity;
+
+    std::unordered_set<uint64_t> overlappingPairs;
+
+    static bool Precedes(const Endpoint &a, const Endpoint &b);
+    void SortAxis(int axis);
+    void AddPair(int proxyA, int proxyB);
+    void RemovePair(int proxyA, int proxyB);
+    void RemovePairKey(int proxy, uint64_t key);
+
+public:
+    SweepAndPrune() = default;
+
+    void AddProxy(EntityId entity, const AABB &box, const CollisionFilter &filter) override;
+    void RemoveProxy(EntityId entity) override;
+    void MoveProxy(EntityId entity, const AABB &box) override;
+    void FindPairs(std::vector<BroadPhasePair> &pairs) override;
+    void QueryAABB(const AABB &region, std::vector<EntityId> &results) const override;
+    void RayCast(const glm::vec2 &from, const glm::vec2 &to, std::vector<RayCastHit> &hits) const override;
+};
@@ -0,0 +1,84 @@
+#include "RenderCommandList.h"
+
+void RenderCommandList::Reset()
+{
+    commands.clear();
+    vertices.clear();
+    indices.clear();
+    rects.clear();
+    callbacks.clear();
+}
+
+void RenderCommandList::Clear(SDL_Color color)
+{
+    commands.push_back({RENDER_COMMAND_CLEAR, nullptr, color, 0, 0, 0, 0});
+}
+
+void RenderCommandList::Geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertexCount, const int *indices, int indexCount)
+{
+    if (indexCount == 0)
+    {
+        return;
+    }
+    commands.push_back({RENDER_COMMAND_GEOMETRY, texture, {255, 255, 255, 255},
+                        static_cast<int>(this->vertices.size()), vertexCount,
+                        static_cast<int>(this->indices.size()), indexCount});
+    this->vertices.insert(this->vertices.end(), vertices, vertices + vertexCount);
+    this->indices.insert(this->indices.end(), indices, indices + indexCount);
+}
+
+void RenderCommandList::FillRects(SDL_Color color, const SDL_Rect *rects, int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    commands.push_back({RENDER_COMMAND_FILL_RECTS, nullptr, color, static_cast<int>(this->rects.size()), count, 0, 0});
+    this->rects.insert(this->rects.end(), rects, rects + count);
+}
+
+void RenderCommandList::DrawRects(SDL_Color color, const SDL_Rect *rects, int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    commands.push_back({RENDER_COMMAND_DRAW_RECTS, nullptr, color, static_cast<int>(this->rects.size()), count, 0, 0});
+    this->rects.insert(this->rects.end(), rects, rects + count);
+}
+
+void RenderCommandList::Callback(std::function<void(SDL_Renderer *)> callback)
+{
+    commands.push_back({RENDER_COMMAND_CALLBACK, nullptr, {0, 0, 0, 0}, static_cast<int>(callbacks.size()), 1, 0, 0});
+    callbacks.push_back(std::move(callback));
+}
+
+void RenderCommandList::Execute(SDL_Renderer *renderer) const
+{
+    for (const auto &command : commands)
+    {
+        switch (command.type)
+        {
+        case RENDER_COMMAND_CLEAR:
+            SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+            SDL_RenderClear(renderer);
+            break;
+        case RENDER_COMMAND_GEOMETRY:
+            SDL_RenderGeometry(renderer, command.texture,
+                               vertices.data() + command.first, command.count,
+                               indices.data() + command.firstIndex, command.indexCount);
+            break;
+        case RENDER_COMMAND_FILL_RECTS:
+            SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+            SDL_RenderFillRects(renderer, rects.data() + command.first, command.count);
+            break;
+        case RENDER_COMMAND_DRAW_RECTS:
+            SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b, command.color.a);
+            SDL_RenderDrawRects(renderer, rects.data() + command.first, command.count);
+            break;
+        case RENDER_COMMAND_CALLBACK:
+            callbacks[command.first](renderer);
+            break;
+        }
+    }
+}
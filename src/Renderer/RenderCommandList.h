@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <functional>
+#include <vector>
+
+enum RenderCommandType
+{
+    RENDER_COMMAND_CLEAR,
+    RENDER_COMMAND_GEOMETRY,
+    RENDER_COMMAND_FILL_RECTS,
+    RENDER_COMMAND_DRAW_RECTS,
+    RENDER_COMMAND_CALLBACK // renderer work that owns its data, e.g. the text or the tilemap
+};
+
+struct RenderCommand
+{
+    RenderCommandType type;
+    SDL_Texture *texture;
+    SDL_Color color;
+    int first; // into the vertices, rects or callbacks of the list
+    int count;
+    int firstIndex;
+    int indexCount;
+};
+
+/*
+RenderCommandList
+One frame of drawing recorded by the render systems, executed later against the SDL_Renderer in recording order.
+The vertex, index and rect data is copied into the list, so the list doesn't point into anything the game
+changes after the frame is submitted. Callbacks cover the work that has to happen on the renderer itself,
+like baking textures, and must only capture copies or state that is only used on the render thread.
+*/
+class RenderCommandList
+{
+private:
+    std::vector<RenderCommand> commands;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    std::vector<SDL_Rect> rects;
+    std::vector<std::function<void(SDL_Renderer *)>> callbacks;
+
+public:
+    RenderCommandList() = default;
+
+    // Empties the list and keeps its buffers for the next frame
+    void Reset();
+
+    void Clear(SDL_Color color);
+
+    // indices are relative to the first of the given vertices, like SDL_RenderGeometry
+    void Geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertexCount, const int *indices, int indexCount);
+    void FillRects(SDL_Color color, const SDL_Rect *rects, int count);
+    void DrawRects(SDL_Color color, const SDL_Rect *rects, int count);
+    void Callback(std::function<void(SDL_Renderer *)> callback);
+
+    void Execute(SDL_Renderer *renderer) const;
+
+    int GetCommandCount() const { return commands.size(); }
+};
@@ -0,0 +1,134 @@
+#include "RenderThread.h"
+
+RenderThread::~RenderThread()
+{
+    if (thread.joinable())
+    {
+        Stop([](SDL_Renderer *) {});
+    }
+}
+
+bool RenderThread::Start(bool isThreaded, std::function<SDL_Renderer *()> createRenderer, std::function<void()> onPresent)
+{
+    this->isThreaded = isThreaded;
+    this->onPresent = onPresent;
+    if (isThreaded)
+    {
+        thread = std::thread(&RenderThread::Loop, this);
+    }
+
+    // the renderer belongs to the thread that creates it
+    Invoke([this, &createRenderer](SDL_Renderer *)
+           { renderer = createRenderer(); });
+    return renderer != nullptr;
+}
+
+void RenderThread::Loop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this]()
+                               { return (readySlot.load() & READY_FLAG) || invokeWork || isStopping; });
+
+            // only run between frames, while the game thread waits for it
+            if (invokeWork)
+            {
+                invokeWork(renderer);
+                invokeWork = nullptr;
+                invokeDone.notify_all();
+                continue;
+            }
+            if (!(readySlot.load() & READY_FLAG))
+            {
+                return; // stopping with nothing left to draw
+            }
+        }
+
+        // swap the executed list for the submitted one
+        executingSlot = readySlot.exchange(executingSlot) & SLOT_MASK;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        framePickedUp.notify_all();
+
+        ExecuteFrame(lists[executingSlot]);
+    }
+}
+
+void RenderThread::ExecuteFrame(RenderCommandList &list)
+{
+    list.Execute(renderer);
+    SDL_RenderPresent(renderer);
+    if (onPresent)
+    {
+        onPresent();
+    }
+}
+
+void RenderThread::Invoke(std::function<void(SDL_Renderer *)> work)
+{
+    if (!isThreaded)
+    {
+        work(renderer);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    invokeWork = work;
+    workAvailable.notify_one();
+    invokeDone.wait(lock, [this]()
+                    { return !invokeWork; });
+}
+
+RenderCommandList &RenderThread::BeginFrame()
+{
+    RenderCommandList &list = lists[recordingSlot];
+    list.Reset();
+    return list;
+}
+
+void RenderThread::Submit()
+{
+    if (!isThreaded)
+    {
+        ExecuteFrame(lists[recordingSlot]);
+        return;
+    }
+
+    // the previous frame has always been picked up, so the slot taken back is free to record into
+    recordingSlot = readySlot.exchange(recordingSlot | READY_FLAG) & SLOT_MASK;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    workAvailable.notify_one();
+
+    // let the game run one frame ahead of the present and no further
+    std::unique_lock<std::mutex> lock(mutex);
+    framePickedUp.wait(lock, [this]()
+                       { return !(readySlot.load() & READY_FLAG); });
+}
+
+void RenderThread::Flush()
+{
+    // invoked work only runs once the frame being drawn is presented
+    Invoke([](SDL_Renderer *) {});
+}
+
+void RenderThread::Stop(std::function<void(SDL_Renderer *)> work)
+{
+    Invoke(work);
+    renderer = nullptr;
+    if (!isThreaded)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    workAvailable.notify_one();
+    thread.join();
+}
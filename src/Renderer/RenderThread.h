@@ -0,0 +1,71 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "RenderCommandList.h"
+
+/*
+RenderThread
+Owns the SDL_Renderer and executes the frames the game records, on a thread of its own so recording frame N+1
+overlaps with drawing and presenting frame N. Every renderer call has to happen on that thread, the game reaches
+the renderer through command lists or through Invoke.
+The lists are triple buffered: the game records into one, the render thread executes another and the third holds
+the latest submitted frame. Handing a frame over is an atomic exchange of the ready slot, the lock is only used to
+sleep. The game waits for the render thread to pick up the previous frame, so it is never more than one frame ahead.
+When it isn't threaded the frames are executed on the calling thread as they are submitted.
+*/
+class RenderThread
+{
+private:
+    static const int READY_FLAG = 4; // set on the ready slot while it holds a frame that hasn't been picked up
+    static const int SLOT_MASK = 3;
+
+    bool isThreaded = false;
+    SDL_Renderer *renderer = nullptr;
+    std::function<void()> onPresent;
+    std::thread thread;
+
+    RenderCommandList lists[3];
+    int recordingSlot = 0; // game thread only
+    int executingSlot = 1; // render thread only
+    std::atomic<int> readySlot{2};
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable framePickedUp;
+    std::condition_variable invokeDone;
+    std::function<void(SDL_Renderer *)> invokeWork;
+    bool isStopping = false;
+
+    void Loop();
+    void ExecuteFrame(RenderCommandList &list);
+
+public:
+    RenderThread() = default;
+    ~RenderThread();
+
+    // Creates the renderer on the render thread, or on the calling thread when not threaded.
+    // onPresent runs on the render thread after each present.
+    bool Start(bool isThreaded, std::function<SDL_Renderer *()> createRenderer, std::function<void()> onPresent);
+
+    // Runs the work on the render thread between two frames and waits for it, for loading and releasing textures
+    void Invoke(std::function<void(SDL_Renderer *)> work);
+
+    // The list to record the next frame into
+    RenderCommandList &BeginFrame();
+
+    // Hands the recorded frame over to be executed and presented
+    void Submit();
+
+    // Waits until every submitted frame has been presented
+    void Flush();
+
+    // Runs the work, e.g. releasing textures and the renderer itself, then stops the thread
+    void Stop(std::function<void(SDL_Renderer *)> work);
+
+    bool IsThreaded() const { return isThreaded; }
+};
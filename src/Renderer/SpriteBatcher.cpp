@@ -0,0 +1,132 @@
+#include "SpriteBatcher.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+const SpriteBatcher::TextureInfo &SpriteBatcher::GetTextureInfo(SDL_Texture *texture)
+{
+    auto info = textureInfos.find(texture);
+    if (info != textureInfos.end())
+    {
+        return info->second;
+    }
+
+    int width = 1;
+    int height = 1;
+    SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+    int slot = textureInfos.size();
+    return textureInfos.emplace(texture, TextureInfo{slot, static_cast<float>(width), static_cast<float>(height)}).first->second;
+}
+
+void SpriteBatcher::Begin()
+{
+    for (auto &batch : batches)
+    {
+        batch.second.vertices.clear();
+        batch.second.indices.clear();
+    }
+    drawCallCount = 0;
+    spriteCount = 0;
+}
+
+void SpriteBatcher::Draw(SDL_Texture *texture, const SDL_Rect &srcRect, const SDL_FRect &dstRect, double angle, SDL_RendererFlip flip, int zIndex)
+{
+    if (!texture)
+    {
+        return;
+    }
+
+    const TextureInfo &info = GetTextureInfo(texture);
+
+    // the sign bit of zIndex is flipped so negative layers sort before positive ones
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(zIndex) ^ 0x80000000u) << 32) | static_cast<uint32_t>(info.slot);
+    Batch &batch = batches[key];
+    batch.texture = texture;
+
+    float u0 = srcRect.x / info.width;
+    float v0 = srcRect.y / info.height;
+    float u1 = (srcRect.x + srcRect.w) / info.width;
+    float v1 = (srcRect.y + srcRect.h) / info.height;
+    if (flip & SDL_FLIP_HORIZONTAL)
+    {
+        std::swap(u0, u1);
+    }
+    if (flip & SDL_FLIP_VERTICAL)
+    {
+        std::swap(v0, v1);
+    }
+
+    // corners relative to the center, in top left, top right, bottom right, bottom left order
+    float halfWidth = dstRect.w * 0.5f;
+    float halfHeight = dstRect.h * 0.5f;
+    float centerX = dstRect.x + halfWidth;
+    float centerY = dstRect.y + halfHeight;
+    const float cornersX[4] = {-halfWidth, halfWidth, halfWidth, -halfWidth};
+    const float cornersY[4] = {-halfHeight, -halfHeight, halfHeight, halfHeight};
+    const float texCoordsU[4] = {u0, u1, u1, u0};
+    const float texCoordsV[4] = {v0, v0, v1, v1};
+
+    float cosine = 1.0f;
+    float sine = 0.0f;
+    if (angle != 0.0)
+    {
+        double radians = glm::radians(angle);
+        cosine = static_cast<float>(std::cos(radians));
+        sine = static_cast<float>(std::sin(radians));
+    }
+
+    int firstVertex = batch.vertices.size();
+    for (int corner = 0; corner < 4; corner++)
+    {
+        SDL_Vertex vertex;
+        vertex.position.x = centerX + cornersX[corner] * cosine - cornersY[corner] * sine;
+        vertex.position.y = centerY + cornersX[corner] * sine + cornersY[corner] * cosine;
+        vertex.color = {255, 255, 255, 255};
+        vertex.tex_coord.x = texCoordsU[corner];
+        vertex.tex_coord.y = texCoordsV[corner];
+        batch.vertices.push_back(vertex);
+    }
+
+    const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+    for (int index : quadIndices)
+    {
+        batch.indices.push_back(firstVertex + index);
+    }
+    spriteCount++;
+}
+
+void SpriteBatcher::End(SDL_Renderer *renderer)
+{
+    for (auto &batch : batches)
+    {
+        if (batch.second.indices.empty())
+        {
+            continue;
+        }
+        SDL_RenderGeometry(renderer, batch.second.texture,
+                           batch.second.vertices.data(), batch.second.vertices.size(),
+                           batch.second.indices.data(), batch.second.indices.size());
+        drawCallCount++;
+    }
+}
+
+void SpriteBatcher::End(RenderCommandList &commands)
+{
+    for (auto &batch : batches)
+    {
+        if (batch.second.indices.empty())
+        {
+            continue;
+        }
+        commands.Geometry(batch.second.texture,
+                          batch.second.vertices.data(), batch.second.vertices.size(),
+                          batch.second.indices.data(), batch.second.indices.size());
+        drawCallCount++;
+    }
+}
+
+void SpriteBatcher::ClearTextureCache()
+{
+    textureInfos.clear();
+    batches.clear();
+}
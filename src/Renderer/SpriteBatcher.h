@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "RenderCommandList.h"
+
+/*
+SpriteBatcher
+Collects sprite quads between Begin and End and submits them with one SDL_RenderGeometry call per (zIndex, texture)
+batch, instead of one SDL_RenderCopyEx per sprite. Rotation and flips are applied to the quad corners and
+texture coordinates on the CPU. Batches are drawn in zIndex order, so with the textures packed into atlas pages
+a whole layer usually goes out in a single call.
+*/
+class SpriteBatcher
+{
+private:
+    struct Batch
+    {
+        SDL_Texture *texture;
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+    };
+
+    struct TextureInfo
+    {
+        int slot; // first-use order, makes the batch order the same every run
+        float width;
+        float height;
+    };
+
+    std::unordered_map<SDL_Texture *, TextureInfo> textureInfos;
+
+    // keyed by zIndex then texture slot, batches keep their buffers between frames
+    std::map<uint64_t, Batch> batches;
+    int drawCallCount = 0;
+    int spriteCount = 0;
+
+    const TextureInfo &GetTextureInfo(SDL_Texture *texture);
+
+public:
+    SpriteBatcher() = default;
+
+    void Begin();
+
+    // dstRect is in screen pixels, the quad is rotated by angle degrees clockwise around its center like SDL_RenderCopyEx
+    void Draw(SDL_Texture *texture, const SDL_Rect &srcRect, const SDL_FRect &dstRect, double angle, SDL_RendererFlip flip, int zIndex);
+
+    // Submits the batches in zIndex order
+    void End(SDL_Renderer *renderer);
+
+    // Records the batches in zIndex order, to be drawn when the list is executed
+    void End(RenderCommandList &commands);
+
+    // Forget the cached texture sizes, e.g. when the textures they belong to are destroyed
+    void ClearTextureCache();
+
+    int GetDrawCallCount() const { return drawCallCount; }
+    int GetSpriteCount() const { return spriteCount; }
+};
@@ -0,0 +1,221 @@
+#include "TextRenderer.h"
+#include "../Logger/Logger.h"
+
+TextRenderer::~TextRenderer()
+{
+    Clear();
+}
+
+TextRenderer::GlyphAtlas *TextRenderer::GetAtlas(const std::string &fontId, TTF_Font *font, SDL_Renderer *renderer)
+{
+    if (!font)
+    {
+        return nullptr;
+    }
+
+    GlyphAtlas &atlas = atlases[fontId];
+    if (atlas.font == font && atlas.texture)
+    {
+        return &atlas;
+    }
+
+    // a new font, or the asset was loaded again with another font, start the atlas over
+    if (atlas.texture)
+    {
+        SDL_DestroyTexture(atlas.texture);
+    }
+    atlas.font = font;
+    atlas.glyphs.clear();
+    atlas.packer = std::make_unique<TextureAtlas>(ATLAS_SIZE, ATLAS_SIZE);
+    atlas.height = TTF_FontHeight(font);
+    atlas.ascent = TTF_FontAscent(font);
+    atlas.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, ATLAS_SIZE, ATLAS_SIZE);
+    if (!atlas.texture)
+    {
+        Logger::Err("Error creating glyph atlas for font " + fontId + ": " + std::string(SDL_GetError()));
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+
+    // the padding between glyphs has to be transparent, static textures start out undefined
+    std::vector<Uint32> emptyPixels(ATLAS_SIZE * ATLAS_SIZE, 0);
+    SDL_UpdateTexture(atlas.texture, NULL, emptyPixels.data(), ATLAS_SIZE * sizeof(Uint32));
+
+    // the glyph references of cached layouts point into the old atlas
+    for (auto &layout : layouts)
+    {
+        if (layout.second.fontId == fontId)
+        {
+            layout.second.texture = nullptr;
+        }
+    }
+    return &atlas;
+}
+
+const TextRenderer::Glyph &TextRenderer::GetGlyph(GlyphAtlas &atlas, Uint16 character)
+{
+    auto cached = atlas.glyphs.find(character);
+    if (cached != atlas.glyphs.end())
+    {
+        return cached->second;
+    }
+
+    Glyph glyph = {{0, 0, 0, 0}, 0, 0, 0};
+    int minX = 0, maxX = 0, minY = 0, maxY = 0, advance = 0;
+    if (TTF_GlyphMetrics(atlas.font, character, &minX, &maxX, &minY, &maxY, &advance) == 0)
+    {
+        glyph.advance = advance;
+    }
+
+    // rendered in white, the vertex colors tint it
+    SDL_Surface *rendered = TTF_RenderGlyph_Blended(atlas.font, character, {255, 255, 255, 255});
+    SDL_Surface *surface = rendered ? SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    if (rendered)
+    {
+        SDL_FreeSurface(rendered);
+    }
+
+    if (surface && surface->w > 0 && surface->h > 0)
+    {
+        if (atlas.packer->Pack(surface->w, surface->h, glyph.rect))
+        {
+            SDL_UpdateTexture(atlas.texture, &glyph.rect, surface->pixels, surface->pitch);
+        }
+        else
+        {
+            Logger::Err("Glyph atlas is full, character " + std::to_string(character) + " is not drawn");
+            glyph.rect = {0, 0, 0, 0};
+        }
+        if (glyph.advance == 0)
+        {
+            glyph.advance = surface->w;
+        }
+
+        // newer SDL_ttf renders the glyph a whole line high from the pen, older versions only the glyph's own box
+        if (surface->h != atlas.height)
+        {
+            glyph.offsetX = minX;
+            glyph.offsetY = atlas.ascent - maxY;
+        }
+    }
+    if (surface)
+    {
+        SDL_FreeSurface(surface);
+    }
+
+    return atlas.glyphs.emplace(character, glyph).first->second;
+}
+
+void TextRenderer::BuildLayout(Layout &layout, GlyphAtlas &atlas)
+{
+    layout.texture = atlas.texture;
+    layout.vertices.clear();
+
+    const float atlasSize = static_cast<float>(ATLAS_SIZE);
+    SDL_Color color = layout.color;
+    color.a = 255; // TTF_RenderText_Blended drew labels opaque whatever the alpha of their color
+    float penX = 0.0f;
+    for (char byte : layout.text)
+    {
+        const Glyph &glyph = GetGlyph(atlas, static_cast<unsigned char>(byte));
+        if (glyph.rect.w > 0)
+        {
+            float x0 = penX + glyph.offsetX;
+            float y0 = static_cast<float>(glyph.offsetY);
+            float x1 = x0 + glyph.rect.w;
+            float y1 = y0 + glyph.rect.h;
+            float u0 = glyph.rect.x / atlasSize;
+            float v0 = glyph.rect.y / atlasSize;
+            float u1 = (glyph.rect.x + glyph.rect.w) / atlasSize;
+            float v1 = (glyph.rect.y + glyph.rect.h) / atlasSize;
+
+            // top left, top right, bottom right, bottom left
+            layout.vertices.push_back({{x0, y0}, color, {u0, v0}});
+            layout.vertices.push_back({{x1, y0}, color, {u1, v0}});
+            layout.vertices.push_back({{x1, y1}, color, {u1, v1}});
+            layout.vertices.push_back({{x0, y1}, color, {u0, v1}});
+        }
+        penX += glyph.advance;
+    }
+}
+
+void TextRenderer::Begin()
+{
+    for (auto &batch : batches)
+    {
+        batch.second.vertices.clear();
+        batch.second.indices.clear();
+    }
+    drawCallCount = 0;
+}
+
+void TextRenderer::Draw(EntityId labelId, const std::string &text, const std::string &fontId, TTF_Font *font, SDL_Color color, float x, float y, SDL_Renderer *renderer)
+{
+    GlyphAtlas *atlas = GetAtlas(fontId, font, renderer);
+    if (!atlas)
+    {
+        return;
+    }
+
+    Layout &layout = layouts[labelId];
+    if (!layout.texture || layout.text != text || layout.fontId != fontId ||
+        layout.color.r != color.r || layout.color.g != color.g || layout.color.b != color.b || layout.color.a != color.a)
+    {
+        layout.text = text;
+        layout.fontId = fontId;
+        layout.color = color;
+        BuildLayout(layout, *atlas);
+    }
+
+    Batch &batch = batches[layout.texture];
+    int firstVertex = batch.vertices.size();
+    for (SDL_Vertex vertex : layout.vertices)
+    {
+        vertex.position.x += x;
+        vertex.position.y += y;
+        batch.vertices.push_back(vertex);
+    }
+
+    const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+    for (size_t quad = 0; quad < layout.vertices.size(); quad += 4)
+    {
+        for (int index : quadIndices)
+        {
+            batch.indices.push_back(firstVertex + quad + index);
+        }
+    }
+}
+
+void TextRenderer::End(SDL_Renderer *renderer)
+{
+    for (auto &batch : batches)
+    {
+        if (batch.second.indices.empty())
+        {
+            continue;
+        }
+        SDL_RenderGeometry(renderer, batch.first,
+                           batch.second.vertices.data(), batch.second.vertices.size(),
+                           batch.second.indices.data(), batch.second.indices.size());
+        drawCallCount++;
+    }
+}
+
+void TextRenderer::Forget(EntityId labelId)
+{
+    layouts.erase(labelId);
+}
+
+void TextRenderer::Clear()
+{
+    for (auto &atlas : atlases)
+    {
+        if (atlas.second.texture)
+        {
+            SDL_DestroyTexture(atlas.second.texture);
+        }
+    }
+    atlases.clear();
+    layouts.clear();
+    batches.clear();
+}
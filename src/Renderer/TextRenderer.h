@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../AssetStore/TextureAtlas.h"
+#include "../ECS/ECS.h"
+
+/*
+TextRenderer
+Draws text from glyph atlases instead of rasterizing and uploading a texture per label every frame.
+Each font gets one atlas texture, and a glyph is rasterized into it the first time it is drawn. The glyphs are
+white, and the label color goes in the vertex colors. A label's quads are laid out once and kept until its text,
+font or color changes. Every frame's labels are then drawn with one SDL_RenderGeometry call per font.
+*/
+class TextRenderer
+{
+private:
+    static constexpr int ATLAS_SIZE = 512;
+
+    struct Glyph
+    {
+        SDL_Rect rect; // in the atlas, empty for glyphs without pixels like the space
+        int offsetX;   // from the pen position and the top of the line to the glyph image
+        int offsetY;
+        int advance;
+    };
+
+    struct GlyphAtlas
+    {
+        TTF_Font *font = nullptr;
+        SDL_Texture *texture = nullptr;
+        std::unique_ptr<TextureAtlas> packer;
+        std::unordered_map<Uint16, Glyph> glyphs;
+        int height = 0;
+        int ascent = 0;
+    };
+
+    // quads relative to the label position, rebuilt when the label changes
+    struct Layout
+    {
+        std::string text;
+        std::string fontId;
+        SDL_Color color;
+        SDL_Texture *texture = nullptr;
+        std::vector<SDL_Vertex> vertices;
+    };
+
+    struct Batch
+    {
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+    };
+
+    std::map<std::string, GlyphAtlas> atlases;
+    std::unordered_map<EntityId, Layout> layouts;
+    std::map<SDL_Texture *, Batch> batches;
+    int drawCallCount = 0;
+
+    GlyphAtlas *GetAtlas(const std::string &fontId, TTF_Font *font, SDL_Renderer *renderer);
+    const Glyph &GetGlyph(GlyphAtlas &atlas, Uint16 character);
+    void BuildLayout(Layout &layout, GlyphAtlas &atlas);
+
+public:
+    TextRenderer() = default;
+    ~TextRenderer();
+
+    void Begin();
+
+    // Queues a label, labelId identifies it across frames so its layout is reused while the text stays the same
+    void Draw(EntityId labelId, const std::string &text, const std::string &fontId, TTF_Font *font, SDL_Color color, float x, float y, SDL_Renderer *renderer);
+
+    void End(SDL_Renderer *renderer);
+
+    // Drops the cached layout of a label that is gone
+    void Forget(EntityId labelId);
+
+    // Destroys the atlas textures, e.g. before the renderer or the fonts go away
+    void Clear();
+
+    int GetDrawCallCount() const { return drawCallCount; }
+};
@@ -0,0 +1,175 @@
+#include "TileMapRenderer.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+
+// the tilemap textures have 10 tiles per row
+const int TILES_PER_TEXTURE_ROW = 10;
+
+TileMapRenderer::~TileMapRenderer()
+{
+    Clear();
+}
+
+int TileMapRenderer::GetScaledTileSize() const
+{
+    return static_cast<int>(tileSize * scale);
+}
+
+void TileMapRenderer::Load(const std::vector<std::vector<int>> &tilemap, const std::string &textureAssetId, int tileSize, double scale, SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore)
+{
+    Clear();
+
+    this->textureAssetId = textureAssetId;
+    this->tileSize = tileSize;
+    this->scale = scale;
+    numRows = tilemap.size();
+    numCols = numRows > 0 ? tilemap[0].size() : 0;
+    tiles.assign(numRows * numCols, 0);
+    for (int row = 0; row < numRows; row++)
+    {
+        for (int col = 0; col < numCols && col < static_cast<int>(tilemap[row].size()); col++)
+        {
+            tiles[row * numCols + col] = tilemap[row][col];
+        }
+    }
+
+    // whole tiles per chunk, so a tile never straddles two chunks
+    tilesPerChunk = std::max(1, CHUNK_SIZE / std::max(1, GetScaledTileSize()));
+    numChunkRows = (numRows + tilesPerChunk - 1) / tilesPerChunk;
+    numChunkCols = (numCols + tilesPerChunk - 1) / tilesPerChunk;
+    chunks.resize(numChunkRows * numChunkCols);
+
+    int chunkPixels = tilesPerChunk * GetScaledTileSize();
+    for (int chunkRow = 0; chunkRow < numChunkRows; chunkRow++)
+    {
+        for (int chunkCol = 0; chunkCol < numChunkCols; chunkCol++)
+        {
+            Chunk &chunk = chunks[chunkRow * numChunkCols + chunkCol];
+            int chunkTileCols = std::min(tilesPerChunk, numCols - chunkCol * tilesPerChunk);
+            int chunkTileRows = std::min(tilesPerChunk, numRows - chunkRow * tilesPerChunk);
+            chunk.bounds = {
+                chunkCol * chunkPixels,
+                chunkRow * chunkPixels,
+                chunkTileCols * GetScaledTileSize(),
+                chunkTileRows * GetScaledTileSize()};
+            BakeChunk(chunk, chunkRow, chunkCol, renderer, assetStore);
+        }
+    }
+
+    Logger::Log("Tilemap baked into " + std::to_string(chunks.size()) + " chunks");
+}
+
+void TileMapRenderer::Clear()
+{
+    for (auto &chunk : chunks)
+    {
+        if (chunk.texture)
+        {
+            SDL_DestroyTexture(chunk.texture);
+        }
+    }
+    chunks.clear();
+    tiles.clear();
+    numRows = 0;
+    numCols = 0;
+}
+
+int TileMapRenderer::GetTile(int row, int col) const
+{
+    if (row < 0 || row >= numRows || col < 0 || col >= numCols)
+    {
+        return 0;
+    }
+    return tiles[row * numCols + col];
+}
+
+void TileMapRenderer::Invalidate(bool texturesLost)
+{
+    for (auto &chunk : chunks)
+    {
+        if (texturesLost && chunk.texture)
+        {
+            SDL_DestroyTexture(chunk.texture);
+            chunk.texture = nullptr;
+        }
+        chunk.isDirty = true;
+    }
+}
+
+void TileMapRenderer::BakeChunk(Chunk &chunk, int chunkRow, int chunkCol, SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore)
+{
+    if (!chunk.texture)
+    {
+        chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, chunk.bounds.w, chunk.bounds.h);
+        if (!chunk.texture)
+        {
+            Logger::Err("Error creating tilemap chunk texture: " + std::string(SDL_GetError()));
+            return;
+        }
+        SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Texture *previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, chunk.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    const TextureRegion &tileRegion = assetStore->GetTextureRegion(textureAssetId);
+    int scaledTileSize = GetScaledTileSize();
+    int firstRow = chunkRow * tilesPerChunk;
+    int firstCol = chunkCol * tilesPerChunk;
+    for (int row = firstRow; row < std::min(firstRow + tilesPerChunk, numRows); row++)
+    {
+        for (int col = firstCol; col < std::min(firstCol + tilesPerChunk, numCols); col++)
+        {
+            int value = tiles[row * numCols + col];
+            SDL_Rect srcRect = {
+                tileRegion.rect.x + (value % TILES_PER_TEXTURE_ROW) * tileSize,
+                tileRegion.rect.y + (value / TILES_PER_TEXTURE_ROW) * tileSize,
+                tileSize,
+                tileSize};
+            SDL_Rect dstRect = {
+                (col - firstCol) * scaledTileSize,
+                (row - firstRow) * scaledTileSize,
+                scaledTileSize,
+                scaledTileSize};
+            SDL_RenderCopy(renderer, tileRegion.texture, &srcRect, &dstRect);
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    chunk.isDirty = false;
+}
+
+void TileMapRenderer::Render(SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore, const SDL_Rect &camera)
+{
+    for (int chunkRow = 0; chunkRow < numChunkRows; chunkRow++)
+    {
+        for (int chunkCol = 0; chunkCol < numChunkCols; chunkCol++)
+        {
+            Chunk &chunk = chunks[chunkRow * numChunkCols + chunkCol];
+
+            // only chunks in the camera view are drawn, or baked again when they're dirty
+            bool outsideCameraView = chunk.bounds.x + chunk.bounds.w < camera.x ||
+                                     chunk.bounds.x > camera.x + camera.w ||
+                                     chunk.bounds.y + chunk.bounds.h < camera.y ||
+                                     chunk.bounds.y > camera.y + camera.h;
+            if (outsideCameraView)
+            {
+                continue;
+            }
+
+            if (chunk.isDirty || !chunk.texture)
+            {
+                BakeChunk(chunk, chunkRow, chunkCol, renderer, assetStore);
+            }
+
+            SDL_Rect dstRect = {
+                chunk.bounds.x - camera.x,
+                chunk.bounds.y - camera.y,
+                chunk.bounds.w,
+                chunk.bounds.h};
+            SDL_RenderCopy(renderer, chunk.texture, NULL, &dstRect);
+        }
+    }
+}
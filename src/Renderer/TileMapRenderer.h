@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../AssetStore/AssetStore.h"
+
+/*
+TileMapRenderer
+Draws the level tilemap from chunks baked into render target textures, instead of one sprite entity per tile.
+Each chunk covers about CHUNK_SIZE x CHUNK_SIZE world pixels and is only baked again when the renderer loses its
+render target, so the background costs a handful of copies per frame.
+*/
+class TileMapRenderer
+{
+private:
+    struct Chunk
+    {
+        SDL_Texture *texture = nullptr;
+        SDL_Rect bounds; // in world pixels
+        bool isDirty = true;
+    };
+
+    std::vector<int> tiles; // tile values row by row
+    int numRows = 0;
+    int numCols = 0;
+    int tileSize = 0;
+    double scale = 1.0;
+    std::string textureAssetId;
+
+    int tilesPerChunk = 1;
+    int numChunkRows = 0;
+    int numChunkCols = 0;
+    std::vector<Chunk> chunks;
+
+    int GetScaledTileSize() const;
+    void BakeChunk(Chunk &chunk, int chunkRow, int chunkCol, SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore);
+
+public:
+    static const int CHUNK_SIZE = 512;
+
+    TileMapRenderer() = default;
+    ~TileMapRenderer();
+
+    // Takes the tile values of the level and bakes every chunk right away
+    void Load(const std::vector<std::vector<int>> &tilemap, const std::string &textureAssetId, int tileSize, double scale, SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore);
+    void Clear();
+
+    int GetTile(int row, int col) const;
+
+    // Marks every chunk for baking again. The render targets lose their content on SDL_RENDER_TARGETS_RESET,
+    // and on SDL_RENDER_DEVICE_RESET the textures themselves are lost and have to be created again.
+    void Invalidate(bool texturesLost);
+
+    void Render(SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore, const SDL_Rect &camera);
+};
@@ -4,10 +4,97 @@
 #include <SDL2/SDL.h>
 #include "../Components/SpriteComponent.h"
 #include "../Components/AnimationComponent.h"
-#include <iostream>
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 
 class AnimationSystem : public System
 {
+private:
+    // Animations are driven by when their frame changes next instead of being recomputed every tick:
+    // the changes wait in a min heap and an update only pops the ones that are due.
+    struct FrameChange
+    {
+        Uint32 time;
+        EntityId entity;
+        unsigned int generation; // changes of an entity that was removed or restarted since are skipped
+    };
+
+    struct LaterChange
+    {
+        bool operator()(const FrameChange &a, const FrameChange &b) const
+        {
+            return a.time > b.time || (a.time == b.time && a.entity > b.entity);
+        }
+    };
+
+    struct Animated
+    {
+        Entity entity;
+        unsigned int generation;
+    };
+
+    std::priority_queue<FrameChange, std::vector<FrameChange>, LaterChange> frameChanges;
+    std::unordered_map<EntityId, Animated> animatedEntities;
+    unsigned int nextGeneration = 0;
+    Uint32 clock = 0; // the animation time of the last update, in milliseconds
+
+    static int GetFrameCount(const AnimationComponent &animation)
+    {
+        return animation.clip ? animation.clip->frames.size() : animation.numFrames;
+    }
+
+    static Uint32 GetFrameDuration(const AnimationComponent &animation)
+    {
+        if (animation.clip)
+        {
+            return std::max<Uint32>(animation.clip->durations[animation.currentFrame], 1);
+        }
+        return 1000 / std::max(animation.frameSpeedRate, 1);
+    }
+
+    static void ApplyFrame(SpriteComponent &sprite, const AnimationComponent &animation)
+    {
+        if (animation.clip)
+        {
+            sprite.srcRect = animation.clip->frames[animation.currentFrame];
+        }
+        else
+        {
+            sprite.srcRect.x = sprite.width * animation.currentFrame;
+        }
+    }
+
+    // Moves to the next frame, false once an animation that doesn't loop is on its last frame
+    static bool NextFrame(AnimationComponent &animation)
+    {
+        int frameCount = GetFrameCount(animation);
+        AnimationLoopMode loopMode = animation.clip ? animation.clip->loopMode : (animation.isLoop ? ANIMATION_LOOP : ANIMATION_ONCE);
+        switch (loopMode)
+        {
+        case ANIMATION_LOOP:
+            animation.currentFrame = (animation.currentFrame + 1) % frameCount;
+            return true;
+        case ANIMATION_ONCE:
+            if (animation.currentFrame + 1 >= frameCount)
+            {
+                animation.isFinished = true;
+                return false;
+            }
+            animation.currentFrame++;
+            return true;
+        case ANIMATION_PING_PONG:
+            if (animation.currentFrame + animation.direction < 0 || animation.currentFrame + animation.direction >= frameCount)
+            {
+                animation.direction = -animation.direction;
+            }
+            animation.currentFrame += animation.direction;
+            return true;
+        }
+        return false;
+    }
+
 public:
     AnimationSystem()
     {
@@ -15,17 +102,87 @@ public:
         RequireComponent<AnimationComponent>();
     }
 
-    void Update()
+    void AddEntityToSystem(Entity entity) override
+    {
+        System::AddEntityToSystem(entity);
+
+        auto &animation = entity.GetComponent<AnimationComponent>();
+        animation.startTime = clock;
+        animation.currentFrame = 0;
+        animation.direction = 1;
+        animation.isFinished = false;
+        if (GetFrameCount(animation) > 0)
+        {
+            ApplyFrame(entity.GetComponent<SpriteComponent>(), animation);
+        }
+
+        unsigned int generation = nextGeneration++;
+        animatedEntities.erase(entity.GetId());
+        animatedEntities.emplace(entity.GetId(), Animated{entity, generation});
+        if (GetFrameCount(animation) > 1)
+        {
+            frameChanges.push({clock + GetFrameDuration(animation), entity.GetId(), generation});
+        }
+    }
+
+    void RemoveEntityFromSystem(Entity entity) override
     {
+        System::RemoveEntityFromSystem(entity);
+        animatedEntities.erase(entity.GetId());
+    }
+
+    // Jumps to a frame right away. The changes already scheduled for the entity are dropped and the next one is
+    // timed from now with the duration of the new frame.
+    void SetFrame(Entity entity, int frame)
+    {
+        auto &animation = entity.GetComponent<AnimationComponent>();
+        int frameCount = GetFrameCount(animation);
+        animation.currentFrame = std::min(std::max(frame, 0), std::max(frameCount - 1, 0));
 
-        for (auto entity : GetSystemEntities())
+        auto animated = animatedEntities.find(entity.GetId());
+        if (animated == animatedEntities.end() || frameCount == 0)
         {
-            auto &sprite = entity.GetComponent<SpriteComponent>();
+            return;
+        }
+        ApplyFrame(entity.GetComponent<SpriteComponent>(), animation);
+        animation.isFinished = false;
+
+        animated->second.generation = nextGeneration++;
+        if (frameCount > 1)
+        {
+            frameChanges.push({clock + GetFrameDuration(animation), entity.GetId(), animated->second.generation});
+        }
+    }
+
+    // time is the animation clock in milliseconds, sampled once for every animation
+    void Update(Uint32 time)
+    {
+        clock = time;
+        while (!frameChanges.empty() && frameChanges.top().time <= clock)
+        {
+            FrameChange change = frameChanges.top();
+            frameChanges.pop();
+
+            auto animated = animatedEntities.find(change.entity);
+            if (animated == animatedEntities.end() || animated->second.generation != change.generation)
+            {
+                continue;
+            }
+            Entity entity = animated->second.entity;
             auto &animation = entity.GetComponent<AnimationComponent>();
 
-            animation.currentFrame = ((SDL_GetTicks() - animation.startTime) * animation.frameSpeedRate / 1000) % animation.numFrames;
+            // catch up with every frame that ended by now, the sprite is only written once
+            Uint32 changeTime = change.time;
+            while (changeTime <= clock && NextFrame(animation))
+            {
+                changeTime += GetFrameDuration(animation);
+            }
+            ApplyFrame(entity.GetComponent<SpriteComponent>(), animation);
 
-            sprite.srcRect.x = sprite.width * animation.currentFrame;
+            if (!animation.isFinished)
+            {
+                frameChanges.push({changeTime, change.entity, change.generation});
+            }
         }
     }
 };
@@ -3,6 +3,7 @@
 #include "../ECS/ECS.h"
 #include "../Components/CameraFollowComponent.h"
 #include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
 #include <SDL2/SDL.h>
 
 class CameraMovementSystem : public System
@@ -14,21 +15,26 @@ public:
         RequireComponent<TransformComponent>();
     }
 
-    void Update(SDL_Rect &camera)
+    void Update(SDL_Rect &camera, double alpha)
     {
         auto entities = GetSystemEntities();
         for (auto entity : entities)
         {
 
             auto &cameraTransform = entity.GetComponent<TransformComponent>();
+            glm::vec2 position = cameraTransform.position;
+            if (entity.HasComponent<RigidBodyComponent>())
+            {
+                position = glm::mix(cameraTransform.previousPosition, cameraTransform.position, static_cast<float>(alpha));
+            }
 
-            if (cameraTransform.position.x + (camera.w / 2) < Game::mapWidth)
+            if (position.x + (camera.w / 2) < Game::mapWidth)
             {
-                camera.x = cameraTransform.position.x - (Game::windowWidth / 2);
+                camera.x = position.x - (Game::windowWidth / 2);
             }
-            if (cameraTransform.position.y + (camera.h / 2) < Game::mapHeight)
+            if (position.y + (camera.h / 2) < Game::mapHeight)
             {
-                camera.y = cameraTransform.position.y - (Game::windowHeight / 2);
+                camera.y = position.y - (Game::windowHeight / 2);
             }
 
             camera.x = camera.x < 0 ? 0 : camera.x;
@@ -2,47 +2,599 @@
 
 #include "../ECS/ECS.h"
 #include "../Components/BoxColliderComponent.h"
+#include "../Components/TransformComponent.h"
 #include "../Logger/Logger.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
+#include "../Events/CollisionStayEvent.h"
+#include "../Events/CollisionExitEvent.h"
 #include "../EventBus/EventBus.h"
+#include "../Physics/AABB.h"
+#include "../Physics/BroadPhase.h"
+#include "../Physics/BruteForceBroadPhase.h"
+#include "../Physics/AABBBatch.h"
+#include "../Physics/SweepAndPrune.h"
+#include "../Physics/AABBTree.h"
+#include "../Physics/StaticAABBTree.h"
+#include "../Physics/SpatialQuery.h"
+#include "../Threading/ThreadPool.h"
+#include <unordered_map>
+#include <algorithm>
 
-class CollisionSystem : public System
+enum BroadPhaseType
 {
+    BROAD_PHASE_BRUTE_FORCE,
+    BROAD_PHASE_SWEEP_AND_PRUNE,
+    BROAD_PHASE_AABB_TREE
+};
+
+class CollisionSystem : public System, public ISpatialQuery
+{
+private:
+    // dynamic colliders live in the broad phase, static ones in an immutable tree that is only rebuilt when they change
+    std::unique_ptr<IBroadPhase> broadPhase;
+    StaticAABBTree staticTree;
+    bool staticTreeDirty = false;
+
+    std::unordered_map<EntityId, Entity> colliderEntities;
+    std::unordered_map<EntityId, Entity> staticColliderEntities;
+    std::vector<BroadPhasePair> candidatePairs;
+    std::vector<EntityId> staticHits;
+
+    // collider boxes indexed by entity id, computed once per frame and reused by every pair test
+    std::vector<AABB> colliderBounds;
+
+    // scratch buffers for the spatial queries
+    std::vector<EntityId> queryIds;
+    std::vector<RayCastHit> queryHits;
+
+    // Bullets are swept from last frame's box to this frame's one, the broad phase sees the union of both.
+    // impact is the earliest time of impact found this frame, 1 when nothing was hit.
+    struct Bullet
+    {
+        AABB previous;
+        AABB current;
+        float impact;
+    };
+    std::unordered_map<EntityId, Bullet> bullets;
+    std::vector<float> contactImpacts;
+
+    // The narrow phase runs on batches of whole pair groups (pairs that share their first entity).
+    // Each thread has its own scratch boxes and contact buffer, the only shared data is read-only.
+    struct NarrowPhaseThread
+    {
+        AABBBatch boxes;
+        std::vector<uint32_t> hitMask;
+        std::vector<BroadPhasePair> contacts;
+    };
+    std::vector<NarrowPhaseThread> narrowPhaseThreads;
+    std::vector<size_t> narrowPhaseBatches; // index of the first pair of each batch, plus the end
+    std::vector<BroadPhasePair> narrowPhaseContacts;
+
+    // small batches aren't worth waking the workers for
+    static constexpr size_t NARROW_PHASE_BATCH_SIZE = 256;
+    static constexpr size_t PARALLEL_NARROW_PHASE_MIN_PAIRS = 2 * NARROW_PHASE_BATCH_SIZE;
+
+    // Contacts from the last frame, keyed by the ordered entity pair, so only state changes become events
+    struct Contact
+    {
+        Entity entity1;
+        Entity entity2;
+        unsigned int lastFrame;
+    };
+    std::unordered_map<uint64_t, Contact> contacts;
+    std::unordered_map<EntityId, std::vector<uint64_t>> entityContacts; // keys of the contacts of each entity
+    std::vector<uint64_t> endedContacts;
+    std::vector<Contact> removedContacts; // contacts of removed colliders, their exit events wait for the next update
+    unsigned int frame = 0;
+    bool emitStayEvents = false; // stay events are only built while someone subscribes to them
+
+    void AddContact(uint64_t key, const Contact &contact)
+    {
+        contacts.emplace(key, contact);
+        entityContacts[contact.entity1.GetId()].push_back(key);
+        entityContacts[contact.entity2.GetId()].push_back(key);
+    }
+
+    void RemoveContactKey(EntityId id, uint64_t key)
+    {
+        auto keys = entityContacts.find(id);
+        if (keys == entityContacts.end())
+        {
+            return;
+        }
+        auto it = std::find(keys->second.begin(), keys->second.end(), key);
+        if (it != keys->second.end())
+        {
+            *it = keys->second.back();
+            keys->second.pop_back();
+        }
+        if (keys->second.empty())
+        {
+            entityContacts.erase(keys);
+        }
+    }
+
+    Contact EraseContact(uint64_t key)
+    {
+        auto contact = contacts.find(key);
+        Contact erased = contact->second;
+        contacts.erase(contact);
+        RemoveContactKey(erased.entity1.GetId(), key);
+        RemoveContactKey(erased.entity2.GetId(), key);
+        return erased;
+    }
+
+    void OnContact(const BroadPhasePair &pair, std::unique_ptr<EventBus> &eventBus)
+    {
+        uint64_t key = GetPairKey(pair.a, pair.b);
+        auto contact = contacts.find(key);
+        if (contact == contacts.end())
+        {
+            Entity &entity1 = GetColliderEntity(pair.a);
+            Entity &entity2 = GetColliderEntity(pair.b);
+            AddContact(key, Contact{entity1, entity2, frame});
+            eventBus->EmitEvent<CollisionEnterEvent>(entity1, entity2);
+            return;
+        }
+
+        contact->second.lastFrame = frame;
+        if (emitStayEvents)
+        {
+            eventBus->EmitEvent<CollisionStayEvent>(contact->second.entity1, contact->second.entity2);
+        }
+    }
+
+    void SetColliderBounds(EntityId id, const AABB &box)
+    {
+        if (id >= static_cast<int>(colliderBounds.size()))
+        {
+            colliderBounds.resize(id + 1);
+        }
+        colliderBounds[id] = box;
+    }
+
+    static bool ComparePairs(const BroadPhasePair &p1, const BroadPhasePair &p2)
+    {
+        return p1.a < p2.a || (p1.a == p2.a && p1.b < p2.b);
+    }
+
+    // Cuts the sorted candidate pairs in batches of about NARROW_PHASE_BATCH_SIZE pairs, without splitting a group
+    void BuildNarrowPhaseBatches()
+    {
+        narrowPhaseBatches.clear();
+        narrowPhaseBatches.push_back(0);
+        size_t batchStart = 0;
+        for (size_t i = 1; i <= candidatePairs.size(); i++)
+        {
+            bool groupEnds = i == candidatePairs.size() || candidatePairs[i].a != candidatePairs[i - 1].a;
+            if (groupEnds && (i - batchStart >= NARROW_PHASE_BATCH_SIZE || i == candidatePairs.size()))
+            {
+                narrowPhaseBatches.push_back(i);
+                batchStart = i;
+            }
+        }
+    }
+
+    // Runs on a worker thread: only reads the candidate pairs and collider bounds, only writes to its thread data
+    void RunNarrowPhaseBatch(int batch, NarrowPhaseThread &thread) const
+    {
+        size_t first = narrowPhaseBatches[batch];
+        size_t end = narrowPhaseBatches[batch + 1];
+        while (first < end)
+        {
+            size_t last = first;
+            thread.boxes.Clear();
+            while (last < end && candidatePairs[last].a == candidatePairs[first].a)
+            {
+                thread.boxes.Add(colliderBounds[candidatePairs[last].b]);
+                last++;
+            }
+
+            OverlapOneVsMany(colliderBounds[candidatePairs[first].a], thread.boxes, 0, last - first, thread.hitMask);
+
+            for (size_t word = 0; word < thread.hitMask.size(); word++)
+            {
+                uint32_t bits = thread.hitMask[word];
+                while (bits != 0)
+                {
+                    thread.contacts.push_back(candidatePairs[first + word * 32 + __builtin_ctz(bits)]);
+                    bits &= bits - 1;
+                }
+            }
+            first = last;
+        }
+    }
+
+    // Time of impact of a contact that involves a bullet, tested in the frame of the second entity.
+    // Returns false when the swept boxes only overlapped because of the union the broad phase saw.
+    bool GetImpact(const BroadPhasePair &pair, float &impact) const
+    {
+        auto bullet1 = bullets.find(pair.a);
+        auto bullet2 = bullets.find(pair.b);
+        AABB from1 = bullet1 != bullets.end() ? bullet1->second.previous : colliderBounds[pair.a];
+        AABB from2 = bullet2 != bullets.end() ? bullet2->second.previous : colliderBounds[pair.b];
+        glm::vec2 displacement(0);
+        if (bullet1 != bullets.end())
+        {
+            displacement += bullet1->second.current.min - from1.min;
+        }
+        if (bullet2 != bullets.end())
+        {
+            displacement -= bullet2->second.current.min - from2.min;
+        }
+        return from1.SweepCast(displacement, from2, impact);
+    }
+
+    // Keeps only the first thing each bullet hit this frame and moves the bullet back to where it hit it
+    void ResolveBulletContacts()
+    {
+        contactImpacts.assign(narrowPhaseContacts.size(), 1.0f);
+        for (size_t i = 0; i < narrowPhaseContacts.size(); i++)
+        {
+            const auto &pair = narrowPhaseContacts[i];
+            if (bullets.count(pair.a) == 0 && bullets.count(pair.b) == 0)
+            {
+                continue;
+            }
+            float impact;
+            if (!GetImpact(pair, impact))
+            {
+                contactImpacts[i] = -1.0f;
+                continue;
+            }
+            contactImpacts[i] = impact;
+            for (auto id : {pair.a, pair.b})
+            {
+                auto bullet = bullets.find(id);
+                if (bullet != bullets.end())
+                {
+                    bullet->second.impact = std::min(bullet->second.impact, impact);
+                }
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < narrowPhaseContacts.size(); i++)
+        {
+            const auto &pair = narrowPhaseContacts[i];
+            bool isFirstHit = contactImpacts[i] >= 0.0f;
+            for (auto id : {pair.a, pair.b})
+            {
+                auto bullet = bullets.find(id);
+                if (bullet != bullets.end() && contactImpacts[i] > bullet->second.impact)
+                {
+                    isFirstHit = false;
+                }
+            }
+            if (isFirstHit)
+            {
+                narrowPhaseContacts[kept++] = pair;
+            }
+        }
+        narrowPhaseContacts.resize(kept);
+
+        for (auto &bullet : bullets)
+        {
+            if (bullet.second.impact < 1.0f)
+            {
+                glm::vec2 displacement = bullet.second.current.min - bullet.second.previous.min;
+                glm::vec2 pullBack = displacement * (1.0f - bullet.second.impact);
+                auto &transform = GetColliderEntity(bullet.first).GetComponent<TransformComponent>();
+                transform.position -= pullBack;
+
+                // rendering interpolates from previousPosition, it has to stay on the part of the sweep before
+                // the hit or the bullet is drawn going through what it hit
+                glm::vec2 start = transform.position - displacement * bullet.second.impact;
+                glm::vec2 travel = transform.position - start;
+                float along = glm::dot(travel, travel) > 0.0f ? glm::dot(transform.previousPosition - start, travel) / glm::dot(travel, travel) : 1.0f;
+                transform.previousPosition = start + travel * glm::clamp(along, 0.0f, 1.0f);
+                bullet.second.current.min -= pullBack;
+                bullet.second.current.max -= pullBack;
+            }
+            bullet.second.previous = bullet.second.current;
+        }
+    }
+
+    // Colliders of the layers in mask whose broad phase box overlaps the region, sorted by id.
+    // Broad phase boxes can be fat or swept, so callers still test the exact collider box.
+    void GatherColliders(const AABB &region, unsigned int mask)
+    {
+        if (staticTreeDirty)
+        {
+            RebuildStaticTree();
+        }
+
+        queryIds.clear();
+        broadPhase->QueryAABB(region, queryIds);
+        staticTree.QueryAABB(region, queryIds);
+        std::sort(queryIds.begin(), queryIds.end());
+        queryIds.erase(std::remove_if(queryIds.begin(), queryIds.end(), [this, mask](EntityId id)
+                                      { return (GetColliderEntity(id).GetComponent<BoxColliderComponent>().layer & mask) == 0; }),
+                       queryIds.end());
+    }
+
+    void RebuildStaticTree()
+    {
+        std::vector<StaticAABBTree::Collider> colliders;
+        colliders.reserve(staticColliderEntities.size());
+        for (auto &collider : staticColliderEntities)
+        {
+            AABB box = GetColliderBounds(collider.second);
+            SetColliderBounds(collider.first, box);
+            colliders.push_back({collider.first, box, GetColliderFilter(collider.second)});
+        }
+        staticTree.Build(colliders);
+        staticTreeDirty = false;
+    }
+
+    Entity &GetColliderEntity(EntityId id)
+    {
+        auto it = colliderEntities.find(id);
+        return it != colliderEntities.end() ? it->second : staticColliderEntities.at(id);
+    }
+
+    AABB GetColliderBounds(Entity entity) const
+    {
+        const auto &box = entity.GetComponent<BoxColliderComponent>();
+        const auto &transform = entity.GetComponent<TransformComponent>();
+        glm::vec2 min = transform.position + box.offset;
+        return AABB(min, min + glm::vec2(box.width, box.height));
+    }
+
+    CollisionFilter GetColliderFilter(Entity entity) const
+    {
+        const auto &box = entity.GetComponent<BoxColliderComponent>();
+        return CollisionFilter(box.layer, box.collisionMask);
+    }
+
 public:
     CollisionSystem()
     {
         RequireComponent<BoxColliderComponent>();
+        RequireComponent<TransformComponent>();
+        SetBroadPhase(BROAD_PHASE_AABB_TREE);
+        Logger::Log("Collision narrow phase kernel: " + std::string(GetOverlapKernelName()));
+    }
+
+    // Swaps the broad phase algorithm, the colliders already in the system are moved over to the new one
+    void SetBroadPhase(BroadPhaseType type)
+    {
+        switch (type)
+        {
+        case BROAD_PHASE_BRUTE_FORCE:
+            broadPhase = std::make_unique<BruteForceBroadPhase>();
+            break;
+        case BROAD_PHASE_SWEEP_AND_PRUNE:
+            broadPhase = std::make_unique<SweepAndPrune>();
+            break;
+        case BROAD_PHASE_AABB_TREE:
+            broadPhase = std::make_unique<AABBTree>();
+            break;
+        }
+
+        for (auto &collider : colliderEntities)
+        {
+            broadPhase->AddProxy(collider.first, GetColliderBounds(collider.second), GetColliderFilter(collider.second));
+        }
+    }
+
+    void AddEntityToSystem(Entity entity) override
+    {
+        System::AddEntityToSystem(entity);
+        if (entity.GetComponent<BoxColliderComponent>().isStatic)
+        {
+            staticColliderEntities.emplace(entity.GetId(), entity);
+            staticTreeDirty = true;
+            return;
+        }
+        colliderEntities.emplace(entity.GetId(), entity);
+        AABB box = GetColliderBounds(entity);
+        broadPhase->AddProxy(entity.GetId(), box, GetColliderFilter(entity));
+        if (entity.GetComponent<BoxColliderComponent>().isBullet)
+        {
+            bullets[entity.GetId()] = Bullet{box, box, 1.0f};
+        }
+    }
+
+    // The contacts of a removed collider end with it. Their exit events come at the start of the next update, so
+    // handlers don't run in the middle of the registry update; by then a killed entity has no components left.
+    void RemoveEntityFromSystem(Entity entity) override
+    {
+        System::RemoveEntityFromSystem(entity);
+
+        bool wasStatic = staticColliderEntities.erase(entity.GetId()) > 0;
+        bool wasDynamic = colliderEntities.erase(entity.GetId()) > 0;
+        if (!wasStatic && !wasDynamic)
+        {
+            return;
+        }
+
+        if (wasStatic)
+        {
+            staticTreeDirty = true;
+        }
+        else
+        {
+            broadPhase->RemoveProxy(entity.GetId());
+            bullets.erase(entity.GetId());
+        }
+
+        auto keys = entityContacts.find(entity.GetId());
+        if (keys == entityContacts.end())
+        {
+            return;
+        }
+        // sorted so the exit events come in a stable order
+        endedContacts = keys->second;
+        std::sort(endedContacts.begin(), endedContacts.end());
+        for (auto key : endedContacts)
+        {
+            removedContacts.push_back(EraseContact(key));
+        }
     }
 
-    void Update(std::unique_ptr<EventBus> &eventBus)
+    void QueryAABB(const AABB &region, unsigned int mask, std::vector<Entity> &results) override
     {
-        auto entities = GetSystemEntities();
-        for (int i = 0; i < entities.size(); i++)
+        GatherColliders(region, mask);
+        for (auto id : queryIds)
         {
-            auto &entity1 = entities[i];
-            auto &box1 = entity1.GetComponent<BoxColliderComponent>();
-            auto &transform1 = entity1.GetComponent<TransformComponent>();
-            for (int j = i + 1; j < entities.size(); j++)
+            Entity &entity = GetColliderEntity(id);
+            if (GetColliderBounds(entity).Overlaps(region))
             {
-                auto &entity2 = entities[j];
-                auto &box2 = entity2.GetComponent<BoxColliderComponent>();
-                auto &transform2 = entity2.GetComponent<TransformComponent>();
-                if (CheckCollision(box1, transform1, box2, transform2))
-                {
-                    // Logger::Log("Entity " + std::to_string(entity1.GetId()) + " collided wih entity " + std::to_string(entity2.GetId()));
+                results.push_back(entity);
+            }
+        }
+    }
 
-                    // emit an event
-                    eventBus->EmitEvent<CollisionEvent>(entity1, entity2);
-                }
+    void QueryRadius(const glm::vec2 &center, float radius, unsigned int mask, std::vector<Entity> &results) override
+    {
+        GatherColliders(AABB(center - glm::vec2(radius), center + glm::vec2(radius)), mask);
+        for (auto id : queryIds)
+        {
+            Entity &entity = GetColliderEntity(id);
+            AABB box = GetColliderBounds(entity);
+            glm::vec2 closest = glm::clamp(center, box.min, box.max);
+            glm::vec2 offset = closest - center;
+            if (glm::dot(offset, offset) <= radius * radius)
+            {
+                results.push_back(entity);
+            }
+        }
+    }
+
+    void RayCast(const glm::vec2 &from, const glm::vec2 &to, unsigned int mask, std::vector<EntityHit> &hits) override
+    {
+        if (staticTreeDirty)
+        {
+            RebuildStaticTree();
+        }
+
+        queryHits.clear();
+        broadPhase->RayCast(from, to, queryHits);
+        staticTree.RayCast(from, to, queryHits);
+
+        size_t firstHit = hits.size();
+        for (const auto &hit : queryHits)
+        {
+            Entity &entity = GetColliderEntity(hit.entity);
+            float fraction;
+            if ((entity.GetComponent<BoxColliderComponent>().layer & mask) != 0 &&
+                GetColliderBounds(entity).RayCast(from, to, fraction))
+            {
+                hits.push_back({entity, fraction, from + (to - from) * fraction});
             }
         }
+        std::sort(hits.begin() + firstHit, hits.end(), [](const EntityHit &a, const EntityHit &b)
+                  { return a.fraction < b.fraction || (a.fraction == b.fraction && a.entity < b.entity); });
     }
 
-    bool CheckCollision(BoxColliderComponent &box1, TransformComponent &transform1, BoxColliderComponent &box2, TransformComponent &transform2)
+    void Update(std::unique_ptr<EventBus> &eventBus, std::unique_ptr<ThreadPool> &threadPool)
     {
-        return transform1.position.x + box1.offset.x + box1.width >= transform2.position.x + box2.offset.x &&
-               transform2.position.x + box2.offset.x + box2.width >= transform1.position.x + box1.offset.x &&
-               transform1.position.y + box1.offset.y + box1.height >= transform2.position.y + box2.offset.y &&
-               transform2.position.y + box2.offset.y + box2.height >= transform1.position.y + box1.offset.y;
+        frame++;
+        emitStayEvents = eventBus->HasSubscribers<CollisionStayEvent>();
+
+        for (const auto &removed : removedContacts)
+        {
+            eventBus->EmitEvent<CollisionExitEvent>(removed.entity1, removed.entity2);
+        }
+        removedContacts.clear();
+
+        // static colliders are usually all added while the level loads, so this runs once
+        if (staticTreeDirty)
+        {
+            RebuildStaticTree();
+        }
+
+        for (auto &collider : colliderEntities)
+        {
+            AABB box = GetColliderBounds(collider.second);
+            auto bullet = bullets.find(collider.first);
+            if (bullet != bullets.end())
+            {
+                bullet->second.current = box;
+                bullet->second.impact = 1.0f;
+                box = box.Union(bullet->second.previous);
+            }
+            SetColliderBounds(collider.first, box);
+            broadPhase->MoveProxy(collider.first, box);
+        }
+
+        // dynamic vs dynamic pairs come from the broad phase, dynamic vs static pairs from the static tree,
+        // both already skip the pairs whose collision layers don't match
+        candidatePairs.clear();
+        broadPhase->FindPairs(candidatePairs);
+
+        if (!staticTree.IsEmpty())
+        {
+            for (auto &collider : colliderEntities)
+            {
+                staticHits.clear();
+                staticTree.QueryAABB(colliderBounds[collider.first], GetColliderFilter(collider.second), staticHits);
+                for (auto staticEntity : staticHits)
+                {
+                    candidatePairs.push_back(GetPairFromKey(GetPairKey(collider.first, staticEntity)));
+                }
+            }
+        }
+
+        // Narrow phase: the pair groups are split in batches and tested on the thread pool, then the contacts
+        // of every thread are merged and sorted so the events come in the same order whatever thread found them
+        std::sort(candidatePairs.begin(), candidatePairs.end(), ComparePairs);
+        BuildNarrowPhaseBatches();
+
+        narrowPhaseThreads.resize(threadPool->GetThreadCount());
+        for (auto &thread : narrowPhaseThreads)
+        {
+            thread.contacts.clear();
+        }
+
+        int batchCount = narrowPhaseBatches.size() - 1;
+        if (candidatePairs.size() >= PARALLEL_NARROW_PHASE_MIN_PAIRS)
+        {
+            threadPool->ParallelFor(batchCount, [this](int batch, int thread)
+                                    { RunNarrowPhaseBatch(batch, narrowPhaseThreads[thread]); });
+        }
+        else
+        {
+            for (int batch = 0; batch < batchCount; batch++)
+            {
+                RunNarrowPhaseBatch(batch, narrowPhaseThreads[0]);
+            }
+        }
+
+        narrowPhaseContacts.clear();
+        for (auto &thread : narrowPhaseThreads)
+        {
+            narrowPhaseContacts.insert(narrowPhaseContacts.end(), thread.contacts.begin(), thread.contacts.end());
+        }
+        std::sort(narrowPhaseContacts.begin(), narrowPhaseContacts.end(), ComparePairs);
+
+        if (!bullets.empty())
+        {
+            ResolveBulletContacts();
+        }
+
+        for (const auto &pair : narrowPhaseContacts)
+        {
+            // Logger::Log("Entity " + std::to_string(pair.a) + " collided wih entity " + std::to_string(pair.b));
+
+            OnContact(pair, eventBus);
+        }
+
+        // Contacts that weren't seen this frame have ended, sorted so the exit events come in a stable order
+        endedContacts.clear();
+        for (auto &contact : contacts)
+        {
+            if (contact.second.lastFrame != frame)
+            {
+                endedContacts.push_back(contact.first);
+            }
+        }
+        std::sort(endedContacts.begin(), endedContacts.end());
+        for (auto key : endedContacts)
+        {
+            Contact ended = EraseContact(key);
+            eventBus->EmitEvent<CollisionExitEvent>(ended.entity1, ended.entity2);
+        }
     }
-};
\ No newline at end of file
+};
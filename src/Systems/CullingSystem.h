@@ -0,0 +1,191 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/ScriptComponent.h"
+#include "../Components/UILabelComponent.h"
+#include "../Physics/AABBTree.h"
+#include <SDL2/SDL.h>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+
+/*
+CullingSystem
+Finds the entities in the camera view once per frame for every render system.
+Entity bounds live in an AABB tree, so the camera query costs about log n plus the number of visible entities.
+Only entities that can move (a rigidbody or a script) have their bounds checked every frame, against a copy of
+their fat box kept next to them, and the tree is only touched for the ones that left it. The others are placed
+once when they join the system. Screen space entities and labels are never culled.
+*/
+class CullingSystem : public System
+{
+private:
+    // render bounds move by more than collider ones between frames, a bigger margin keeps tree updates rare
+    static constexpr float TREE_MARGIN = 32.0f;
+    // health bars and labels hang a little outside of their sprites
+    static constexpr int CAMERA_MARGIN = 32;
+
+    AABBTree tree{TREE_MARGIN};
+    std::unordered_map<EntityId, Entity> worldEntities;
+
+    // Moving entities are packed so the per-frame check is a straight walk. Their proxies are only moved when
+    // they leave their fat box, so the exact boxes in the tree can be up to TREE_MARGIN behind.
+    struct MovingEntity
+    {
+        Entity entity;
+        AABB fatBox;
+    };
+    std::vector<MovingEntity> movingEntities;
+    std::unordered_map<EntityId, int> movingIndices;
+    std::map<EntityId, Entity> alwaysVisibleEntities;
+
+    std::vector<EntityId> queryResults;
+    std::vector<Entity> visibleEntities;
+    std::vector<bool> isVisible; // indexed by entity id
+
+    // Screen space entities, and labels: the size of their text is only known once the font draws it
+    static bool IsAlwaysVisible(Entity entity)
+    {
+        if (entity.GetComponent<TransformComponent>().isFixed || entity.HasComponent<UILabelComponent>())
+        {
+            return true;
+        }
+        return entity.HasComponent<SpriteComponent>() && entity.GetComponent<SpriteComponent>().isFixed;
+    }
+
+    // World bounds of what gets drawn for the entity, covering its whole move since the last tick
+    static AABB GetRenderBounds(Entity entity)
+    {
+        const auto &transform = entity.GetComponent<TransformComponent>();
+        glm::vec2 size(0);
+        if (entity.HasComponent<SpriteComponent>())
+        {
+            const auto &sprite = entity.GetComponent<SpriteComponent>();
+            size = glm::vec2(sprite.width * transform.scale.x, sprite.height * transform.scale.y);
+        }
+
+        AABB box(transform.position, transform.position + size);
+        if (transform.rotation != 0.0)
+        {
+            // the sprite rotates around its center, the circle through its corners contains it at any angle
+            glm::vec2 center = transform.position + size * 0.5f;
+            float radius = glm::length(size) * 0.5f;
+            box = AABB(center - glm::vec2(radius), center + glm::vec2(radius));
+        }
+
+        glm::vec2 offset = transform.previousPosition - transform.position;
+        return box.Union(AABB(box.min + offset, box.max + offset));
+    }
+
+public:
+    CullingSystem()
+    {
+        RequireComponent<TransformComponent>();
+    }
+
+    void AddEntityToSystem(Entity entity) override
+    {
+        System::AddEntityToSystem(entity);
+        if (IsAlwaysVisible(entity))
+        {
+            alwaysVisibleEntities.emplace(entity.GetId(), entity);
+            return;
+        }
+        worldEntities.emplace(entity.GetId(), entity);
+        tree.AddProxy(entity.GetId(), GetRenderBounds(entity), CollisionFilter());
+        if (entity.HasComponent<RigidBodyComponent>() || entity.HasComponent<ScriptComponent>())
+        {
+            movingIndices[entity.GetId()] = movingEntities.size();
+            movingEntities.push_back({entity, tree.GetFatBox(entity.GetId())});
+        }
+    }
+
+    void RemoveEntityFromSystem(Entity entity) override
+    {
+        System::RemoveEntityFromSystem(entity);
+        if (alwaysVisibleEntities.erase(entity.GetId()) > 0)
+        {
+            return;
+        }
+        if (worldEntities.erase(entity.GetId()) > 0)
+        {
+            auto moving = movingIndices.find(entity.GetId());
+            if (moving != movingIndices.end())
+            {
+                int index = moving->second;
+                movingIndices.erase(moving);
+                if (index != static_cast<int>(movingEntities.size()) - 1)
+                {
+                    movingEntities[index] = movingEntities.back();
+                    movingIndices[movingEntities[index].entity.GetId()] = index;
+                }
+                movingEntities.pop_back();
+            }
+            tree.RemoveProxy(entity.GetId());
+        }
+    }
+
+    void Update(const SDL_Rect &camera)
+    {
+        for (auto entity : visibleEntities)
+        {
+            isVisible[entity.GetId()] = false;
+        }
+        visibleEntities.clear();
+
+        for (auto &moving : movingEntities)
+        {
+            AABB box = GetRenderBounds(moving.entity);
+            if (!moving.fatBox.Contains(box))
+            {
+                tree.MoveProxy(moving.entity.GetId(), box);
+                moving.fatBox = tree.GetFatBox(moving.entity.GetId());
+            }
+        }
+
+        // the tree may hold a box up to TREE_MARGIN behind a moving entity, so it is asked about a bigger view
+        // and the entities it returns are tested with their current bounds
+        AABB view(glm::vec2(camera.x - CAMERA_MARGIN, camera.y - CAMERA_MARGIN),
+                  glm::vec2(camera.x + camera.w + CAMERA_MARGIN, camera.y + camera.h + CAMERA_MARGIN));
+        queryResults.clear();
+        tree.QueryAABB(view.Expand(TREE_MARGIN), queryResults);
+        std::sort(queryResults.begin(), queryResults.end());
+
+        for (auto id : queryResults)
+        {
+            Entity &entity = worldEntities.at(id);
+            if (!GetRenderBounds(entity).Overlaps(view))
+            {
+                continue;
+            }
+            visibleEntities.push_back(entity);
+        }
+        for (auto &entity : alwaysVisibleEntities)
+        {
+            visibleEntities.push_back(entity.second);
+        }
+
+        for (auto entity : visibleEntities)
+        {
+            if (entity.GetId() >= static_cast<int>(isVisible.size()))
+            {
+                isVisible.resize(entity.GetId() + 1, false);
+            }
+            isVisible[entity.GetId()] = true;
+        }
+    }
+
+    bool IsVisible(Entity entity) const
+    {
+        return entity.GetId() < static_cast<int>(isVisible.size()) && isVisible[entity.GetId()];
+    }
+
+    // Visible entities, the ones in the camera view sorted by id, then the ones that are always visible
+    const std::vector<Entity> &GetVisibleEntities() const
+    {
+        return visibleEntities;
+    }
+};
@@ -3,7 +3,7 @@
 #include "../ECS/ECS.h"
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/ProjectileComponent.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
 #include "../EventBus/EventBus.h"
 #include "../Logger/Logger.h"
 #include "../Components/HealthComponent.h"
@@ -19,10 +19,10 @@ public:
 
     void SubscribeToEvents(std::unique_ptr<EventBus> &eventBus)
     {
-        eventBus->SubscribeToEvent<CollisionEvent>(this, &DamageSystem::OnCollision);
+        eventBus->SubscribeToEvent<CollisionEnterEvent>(this, &DamageSystem::OnCollision);
     }
 
-    void OnCollision(CollisionEvent &event)
+    void OnCollision(CollisionEnterEvent &event)
     {
         Logger::Log("Entity " + std::to_string(event.entity1.GetId()) + " collided with entity " + std::to_string(event.entity2.GetId()));
 
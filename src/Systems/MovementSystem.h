@@ -3,7 +3,7 @@
 #include "../ECS/ECS.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
-#include "../Events/CollisionEvent.h"
+#include "../Events/CollisionEnterEvent.h"
 #include "../EventBus/EventBus.h"
 #include "../Logger/Logger.h"
 #include "../Components/ProjectileComponent.h"
@@ -21,10 +21,10 @@ public:
 
     void SubscribeToEvents(std::unique_ptr<EventBus> &eventBus)
     {
-        eventBus->SubscribeToEvent<CollisionEvent>(this, &MovementSystem::OnCollision);
+        eventBus->SubscribeToEvent<CollisionEnterEvent>(this, &MovementSystem::OnCollision);
     }
 
-    void OnCollision(CollisionEvent &event)
+    void OnCollision(CollisionEnterEvent &event)
     {
         if (event.entity1.BelongsToGroup("obstacles") && event.entity2.BelongsToGroup("enemies"))
         {
@@ -68,6 +68,7 @@ public:
             auto &transform = entity.GetComponent<TransformComponent>();
             const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
 
+            transform.previousPosition = transform.position;
             transform.position.x += rigidbody.velocity.x * deltaTime;
             transform.position.y += rigidbody.velocity.y * deltaTime;
 
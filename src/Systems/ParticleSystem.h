@@ -0,0 +1,232 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../AssetStore/AssetStore.h"
+#include "../Particles/ParticleBuffer.h"
+#include "../Renderer/RenderCommandList.h"
+#include "../Logger/Logger.h"
+#include <SDL2/SDL.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class ParticleSystem : public System
+{
+private:
+    // Emitters that draw their particles the same way share a pool, each pool is one geometry call
+    struct Pool
+    {
+        std::string assetId;
+        int width;
+        int height;
+        int numFrames;
+        bool isAnimated;
+        bool isFading;
+        float scale;
+        ParticleBuffer particles;
+        std::vector<SDL_Vertex> vertices;
+    };
+
+    std::vector<std::unique_ptr<Pool>> pools;
+    std::vector<int> quadIndices; // the same for every pool, grown as needed
+    std::mt19937 random{1};       // seeded the same every run, so headless runs draw the same frames
+    float lastDeltaTime = 0.0f;
+
+    int GetPool(const ParticleEmitterComponent &emitter)
+    {
+        for (size_t i = 0; i < pools.size(); i++)
+        {
+            const Pool &pool = *pools[i];
+            if (pool.assetId == emitter.assetId && pool.width == emitter.width && pool.height == emitter.height &&
+                pool.numFrames == std::max(emitter.numFrames, 1) && pool.isAnimated == emitter.isAnimated &&
+                pool.isFading == emitter.isFading && pool.scale == emitter.scale)
+            {
+                return i;
+            }
+        }
+
+        auto pool = std::make_unique<Pool>();
+        pool->assetId = emitter.assetId;
+        pool->width = emitter.width;
+        pool->height = emitter.height;
+        pool->numFrames = std::max(emitter.numFrames, 1);
+        pool->isAnimated = emitter.isAnimated;
+        pool->isFading = emitter.isFading;
+        pool->scale = emitter.scale;
+        pools.push_back(std::move(pool));
+        return pools.size() - 1;
+    }
+
+    float RandomBetween(float min, float max)
+    {
+        return min + (max - min) * std::uniform_real_distribution<float>(0.0f, 1.0f)(random);
+    }
+
+    void Spawn(Pool &pool, const ParticleEmitterComponent &emitter, glm::vec2 position, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            int slot = pool.particles.Emit();
+            float angle = glm::radians(emitter.direction + RandomBetween(-0.5f, 0.5f) * emitter.spread);
+            float speed = RandomBetween(emitter.minSpeed, emitter.maxSpeed);
+            float life = std::max(RandomBetween(emitter.minLife, emitter.maxLife), 1.0f) * 0.001f;
+
+            pool.particles.positionX[slot] = position.x;
+            pool.particles.positionY[slot] = position.y;
+            pool.particles.velocityX[slot] = std::cos(angle) * speed;
+            pool.particles.velocityY[slot] = std::sin(angle) * speed;
+            pool.particles.accelerationX[slot] = emitter.acceleration.x;
+            pool.particles.accelerationY[slot] = emitter.acceleration.y;
+            pool.particles.life[slot] = life;
+            pool.particles.inverseLifetime[slot] = 1.0f / life;
+            pool.particles.color[slot] = emitter.color;
+            pool.particles.frame[slot] = pool.isAnimated ? 0 : std::uniform_int_distribution<int>(0, std::min(pool.numFrames, 256) - 1)(random);
+        }
+    }
+
+    void DrawPool(RenderCommandList &commands, std::unique_ptr<AssetStore> &assetStore, SDL_Rect &camera, float lag, Pool &pool)
+    {
+        const ParticleBuffer &particles = pool.particles;
+        const TextureRegion &region = assetStore->GetTextureRegion(pool.assetId);
+        if (!region.texture || particles.GetCount() == 0)
+        {
+            return;
+        }
+
+        int textureWidth = 1;
+        int textureHeight = 1;
+        SDL_QueryTexture(region.texture, NULL, NULL, &textureWidth, &textureHeight);
+        float frameU = static_cast<float>(pool.width) / textureWidth;
+        float frameV = static_cast<float>(pool.height) / textureHeight;
+        float regionU = static_cast<float>(region.rect.x) / textureWidth;
+        float regionV = static_cast<float>(region.rect.y) / textureHeight;
+
+        float halfWidth = pool.width * pool.scale * 0.5f;
+        float halfHeight = pool.height * pool.scale * 0.5f;
+        float left = camera.x - halfWidth;
+        float top = camera.y - halfHeight;
+        float right = camera.x + camera.w + halfWidth;
+        float bottom = camera.y + camera.h + halfHeight;
+
+        pool.vertices.clear();
+        for (int i = 0; i < particles.GetCount(); i++)
+        {
+            int slot = particles.GetSlot(i);
+            float life = particles.life[slot];
+            if (life <= 0.0f)
+            {
+                continue;
+            }
+
+            // drawn between the last two ticks, like the entities, by stepping back along the velocity
+            float x = particles.positionX[slot] - particles.velocityX[slot] * lag;
+            float y = particles.positionY[slot] - particles.velocityY[slot] * lag;
+            if (x < left || x > right || y < top || y > bottom)
+            {
+                continue;
+            }
+
+            float age = std::min(std::max(1.0f - life * particles.inverseLifetime[slot], 0.0f), 1.0f);
+            int frame = pool.isAnimated ? std::min(static_cast<int>(age * pool.numFrames), pool.numFrames - 1) : particles.frame[slot];
+            SDL_Color color = particles.color[slot];
+            if (pool.isFading)
+            {
+                color.a = static_cast<Uint8>(color.a * (1.0f - age));
+            }
+
+            float u0 = regionU + frame * frameU;
+            float v0 = regionV;
+            float u1 = u0 + frameU;
+            float v1 = v0 + frameV;
+            x -= camera.x;
+            y -= camera.y;
+            pool.vertices.push_back({{x - halfWidth, y - halfHeight}, color, {u0, v0}});
+            pool.vertices.push_back({{x + halfWidth, y - halfHeight}, color, {u1, v0}});
+            pool.vertices.push_back({{x + halfWidth, y + halfHeight}, color, {u1, v1}});
+            pool.vertices.push_back({{x - halfWidth, y + halfHeight}, color, {u0, v1}});
+        }
+
+        int quadCount = pool.vertices.size() / 4;
+        for (int quad = quadIndices.size() / 6; quad < quadCount; quad++)
+        {
+            for (int index : {0, 1, 2, 0, 2, 3})
+            {
+                quadIndices.push_back(quad * 4 + index);
+            }
+        }
+        commands.Geometry(region.texture, pool.vertices.data(), pool.vertices.size(), quadIndices.data(), quadCount * 6);
+    }
+
+public:
+    ParticleSystem()
+    {
+        RequireComponent<TransformComponent>();
+        RequireComponent<ParticleEmitterComponent>();
+        Logger::Log("Particle update kernel: " + std::string(GetParticleKernelName()));
+    }
+
+    void AddEntityToSystem(Entity entity) override
+    {
+        System::AddEntityToSystem(entity);
+
+        auto &emitter = entity.GetComponent<ParticleEmitterComponent>();
+        const auto &transform = entity.GetComponent<TransformComponent>();
+        emitter.pool = GetPool(emitter);
+        emitter.pendingParticles = 0.0;
+        emitter.elapsed = 0.0;
+        Spawn(*pools[emitter.pool], emitter, transform.position + emitter.offset, emitter.burst);
+    }
+
+    // Emits from the emitters and moves every particle, once per simulation tick
+    void Update(double deltaTime)
+    {
+        for (auto entity : GetSystemEntities())
+        {
+            auto &emitter = entity.GetComponent<ParticleEmitterComponent>();
+            if (emitter.duration > 0 && emitter.elapsed >= emitter.duration)
+            {
+                continue;
+            }
+            emitter.elapsed += deltaTime * 1000.0;
+
+            // a rate that isn't a multiple of the tick rate carries the fraction over to the next tick
+            emitter.pendingParticles += emitter.rate * deltaTime;
+            int count = static_cast<int>(emitter.pendingParticles);
+            emitter.pendingParticles -= count;
+            Spawn(*pools[emitter.pool], emitter, entity.GetComponent<TransformComponent>().position + emitter.offset, count);
+        }
+
+        lastDeltaTime = static_cast<float>(deltaTime);
+        for (auto &pool : pools)
+        {
+            pool->particles.Update(lastDeltaTime);
+        }
+    }
+
+    // Records one geometry command per pool, drawn over the sprites.
+    // alpha is how far the frame is between the last two simulation ticks
+    void Render(RenderCommandList &commands, std::unique_ptr<AssetStore> &assetStore, SDL_Rect &camera, double alpha)
+    {
+        float lag = static_cast<float>(1.0 - alpha) * lastDeltaTime;
+        for (auto &pool : pools)
+        {
+            DrawPool(commands, assetStore, camera, lag, *pool);
+        }
+    }
+
+    int GetParticleCount() const
+    {
+        int count = 0;
+        for (const auto &pool : pools)
+        {
+            count += pool->particles.GetCount();
+        }
+        return count;
+    }
+};
@@ -11,19 +11,57 @@
 #include "../Logger/Logger.h"
 #include "../Events/KeyPressedEvent.h"
 #include "../EventBus/EventBus.h"
+#include "../Game/TimerWheel.h"
 #include <iostream>
 
 class ProjectileEmitSystem : public System
 {
 
 private:
-    void AddComponents(Entity &entity, Entity &projectile, ProjectileEmitterComponent &emitter, TransformComponent transform, glm::vec2 projectileVelocity, glm::vec2 projectilePosition)
+    static const int PREWARMED_PROJECTILES = 256;
+
+    int projectilePool = -1;
+    TimerWheel &timerWheel;
+
+    // The components every projectile has, set up once when the pooled entity is built
+    static void BuildProjectile(Entity &projectile)
     {
-        projectile.AddComponent<TransformComponent>(projectilePosition, glm::vec2(1.0, 1.0), 0);
-        projectile.AddComponent<RigidBodyComponent>(projectileVelocity);
+        projectile.Group("projectiles");
+        projectile.AddComponent<TransformComponent>(glm::vec2(0), glm::vec2(1.0, 1.0), 0);
+        projectile.AddComponent<RigidBodyComponent>();
         projectile.AddComponent<SpriteComponent>("projectile", 4, 4, 4);
-        projectile.AddComponent<BoxColliderComponent>(4, 4);
-        projectile.AddComponent<ProjectileComponent>(emitter.isFriendly, emitter.hitPercentageDamage, emitter.projectileDuration, entity.GetId());
+        // projectiles never hit each other
+        projectile.AddComponent<BoxColliderComponent>(4, 4, glm::vec2(0), false, COLLISION_LAYER_PROJECTILE, COLLISION_LAYER_ALL & ~COLLISION_LAYER_PROJECTILE, true);
+        projectile.AddComponent<ProjectileComponent>();
+    }
+
+    // Wakes a projectile from the pool and resets the components that differ between shots
+    void SpawnProjectile(Entity &entity, ProjectileEmitterComponent &emitter, glm::vec2 projectileVelocity, glm::vec2 projectilePosition)
+    {
+        Entity projectile = entity.registry->WakePooledEntity(projectilePool);
+
+        auto &transform = projectile.GetComponent<TransformComponent>();
+        transform.position = projectilePosition;
+        transform.previousPosition = projectilePosition;
+
+        projectile.GetComponent<RigidBodyComponent>().velocity = projectileVelocity;
+
+        auto &projectileComponent = projectile.GetComponent<ProjectileComponent>();
+        projectileComponent.isFriendly = emitter.isFriendly;
+        projectileComponent.damage = emitter.hitPercentageDamage;
+        projectileComponent.duration = emitter.projectileDuration;
+        projectileComponent.ownerEntityId = entity.GetId();
+    }
+
+    // Fires the projectile of an emitter that shoots on its own, from its emission timer
+    void Emit(Entity entity)
+    {
+        auto &emitter = entity.GetComponent<ProjectileEmitterComponent>();
+        const auto transform = entity.GetComponent<TransformComponent>();
+
+        glm::vec2 projectilePosition = transform.position;
+        setProjectilePosition(entity, projectilePosition, transform);
+        SpawnProjectile(entity, emitter, emitter.projectileVelocity, projectilePosition);
     }
 
     void setProjectilePosition(Entity &entity, glm::vec2 &projectilePosition, TransformComponent transform)
@@ -37,12 +75,40 @@ private:
     }
 
 public:
-    ProjectileEmitSystem()
+    ProjectileEmitSystem(TimerWheel &timerWheel) : timerWheel(timerWheel)
     {
         RequireComponent<ProjectileEmitterComponent>();
         RequireComponent<TransformComponent>();
     }
 
+    // Emitters with a frequency register a repeating timer once, instead of every emitter being checked every tick
+    void AddEntityToSystem(Entity entity) override
+    {
+        System::AddEntityToSystem(entity);
+        auto &emitter = entity.GetComponent<ProjectileEmitterComponent>();
+        if (emitter.frequency > 0)
+        {
+            emitter.emissionTimer = timerWheel.ScheduleRepeating(timerWheel.MillisecondsToTicks(emitter.frequency), [this, entity]()
+                                                                 { Emit(entity); });
+        }
+    }
+
+    void RemoveEntityFromSystem(Entity entity) override
+    {
+        System::RemoveEntityFromSystem(entity);
+        if (entity.HasComponent<ProjectileEmitterComponent>())
+        {
+            timerWheel.Cancel(entity.GetComponent<ProjectileEmitterComponent>().emissionTimer);
+        }
+    }
+
+    // Projectiles are pooled entities: expired and destroyed ones go back to sleep in the pool and the next shots
+    // reuse them, so firing doesn't create entities or components once the pool is big enough
+    void CreateProjectilePool(std::unique_ptr<Registry> &registry)
+    {
+        projectilePool = registry->CreateEntityPool(BuildProjectile, PREWARMED_PROJECTILES);
+    }
+
     void SubscribeToEvents(std::unique_ptr<EventBus> &eventBus)
     {
         // emit a projectile on space key press
@@ -53,7 +119,6 @@ public:
     {
         if (event.key == SDLK_SPACE)
         {
-            Logger::Err("Space key pressed");
             for (auto entity : GetSystemEntities())
             {
                 if (entity.HasTag("player")) // identify if the entity is the player
@@ -91,11 +156,7 @@ public:
                         projectileVelocity.x *= directionX;
                         projectileVelocity.y *= directionY;
 
-                        // add projectile to the registry
-                        auto projectile = entity.registry->CreateEntity();
-
-                        projectile.Group("projectiles");
-                        AddComponents(entity, projectile, emitter, transform, projectileVelocity, projectilePosition);
+                        SpawnProjectile(entity, emitter, projectileVelocity, projectilePosition);
 
                         emitter.lastEmmissionTime = SDL_GetTicks();
                     }
@@ -103,37 +164,4 @@ public:
             }
         }
     }
-
-    void Update(std::unique_ptr<Registry> &registry)
-    {
-        for (auto entity : GetSystemEntities())
-        {
-            auto &emitter = entity.GetComponent<ProjectileEmitterComponent>();
-            const auto transform = entity.GetComponent<TransformComponent>();
-
-            if (emitter.frequency == 0)
-                continue;
-
-            if (SDL_GetTicks() - emitter.lastEmmissionTime > emitter.frequency)
-            {
-
-                glm::vec2 projectilePosition = transform.position;
-                if (entity.HasComponent<SpriteComponent>())
-                {
-                    const auto sprite = entity.GetComponent<SpriteComponent>();
-                    projectilePosition.x += (transform.scale.x * sprite.width / 2);
-                    projectilePosition.y += (transform.scale.y * sprite.height / 2);
-                }
-                // add projectile to the registry
-                auto projectile = registry->CreateEntity();
-                projectile.Group("projectiles");
-
-                AddComponents(entity, projectile, emitter, transform, emitter.projectileVelocity, projectilePosition);
-
-                // Logger::Err("Projectile emitted");
-
-                emitter.lastEmmissionTime = SDL_GetTicks();
-            }
-        }
-    }
 };
\ No newline at end of file
@@ -2,26 +2,35 @@
 
 #include "../ECS/ECS.h"
 #include "../Components/ProjectileComponent.h"
+#include "../Game/TimerWheel.h"
 #include <SDL2/SDL.h>
 
+// Projectiles register their expiry with the timer wheel when they join, instead of every projectile being checked every tick
 class ProjectileLifecycleSystem : public System
 {
+private:
+    TimerWheel &timerWheel;
+
 public:
-    ProjectileLifecycleSystem()
+    ProjectileLifecycleSystem(TimerWheel &timerWheel) : timerWheel(timerWheel)
     {
         RequireComponent<ProjectileComponent>();
     }
 
-    void Update()
+    void AddEntityToSystem(Entity entity) override
+    {
+        System::AddEntityToSystem(entity);
+        auto &projectile = entity.GetComponent<ProjectileComponent>();
+        projectile.expiryTimer = timerWheel.ScheduleKill(timerWheel.MillisecondsToTicks(projectile.duration), entity);
+    }
+
+    // a projectile destroyed before it expires, or put back in its pool, must not be killed by its old timer
+    void RemoveEntityFromSystem(Entity entity) override
     {
-        auto entities = GetSystemEntities();
-        for (auto &entity : entities)
+        System::RemoveEntityFromSystem(entity);
+        if (entity.HasComponent<ProjectileComponent>())
         {
-            auto &projectile = entity.GetComponent<ProjectileComponent>();
-            if (SDL_GetTicks() - projectile.startTime >= projectile.duration)
-            {
-                entity.Kill();
-            }
+            timerWheel.Cancel(entity.GetComponent<ProjectileComponent>().expiryTimer);
         }
     }
-};
\ No newline at end of file
+};
@@ -14,13 +14,42 @@
 #include <glm/glm.hpp>
 #include "../Logger/Logger.h"
 #include "../ECS/ECS.h"
+#include "../Game/FramePacer.h"
+#include "../Game/InputLatencyTracker.h"
+#include "../Renderer/RenderCommandList.h"
+#include <memory>
 
 class RenderGuiSystem : public System
 {
+private:
+    // ImGui reuses its draw lists on the next frame, so the render thread draws from a copy
+    struct GuiDrawData
+    {
+        ImDrawData drawData;
+
+        GuiDrawData(const ImDrawData &source)
+        {
+            drawData = source;
+            drawData.CmdLists.clear();
+            for (const ImDrawList *list : source.CmdLists)
+            {
+                drawData.CmdLists.push_back(list->CloneOutput());
+            }
+        }
+
+        ~GuiDrawData()
+        {
+            for (ImDrawList *list : drawData.CmdLists)
+            {
+                IM_DELETE(list);
+            }
+        }
+    };
+
 public:
     RenderGuiSystem() = default;
 
-    void Update(SDL_Renderer *renderer, std::unique_ptr<Registry> &registry)
+    void Update(RenderCommandList &commands, std::unique_ptr<Registry> &registry, FramePacer &framePacer, const InputLatencyTracker &inputLatencyTracker)
     {
         ImVec4 red = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
         ImVec4 green = ImVec4(0.0f, 1.0f, 0.0f, 1.0f);
@@ -90,7 +119,7 @@ public:
             enemy.AddComponent<TransformComponent>(glm::vec2(enemyXPos, enemyYPos), glm::vec2(scaleX, scaleY), enemyRotation, false);
             enemy.AddComponent<RigidBodyComponent>(glm::vec2(enemySpeedX, enemySpeedY));
             enemy.AddComponent<SpriteComponent>(sprites[selectedSprite], TILE_SIZE, TILE_SIZE, 2);
-            enemy.AddComponent<BoxColliderComponent>(TILE_SIZE, TILE_SIZE);
+            enemy.AddComponent<BoxColliderComponent>(TILE_SIZE, TILE_SIZE, glm::vec2(0), false, COLLISION_LAYER_ENEMY);
 
             if (emitBullets)
             {
@@ -116,10 +145,38 @@ public:
         }
         ImGui::End();
 
+        ImGui::Begin("Frame Pacing");
+        const char *modes[] = {
+            FramePacer::GetModeName(FRAME_PACING_UNCAPPED),
+            FramePacer::GetModeName(FRAME_PACING_VSYNC),
+            FramePacer::GetModeName(FRAME_PACING_FIXED),
+            FramePacer::GetModeName(FRAME_PACING_POWER_SAVE)};
+        int mode = framePacer.GetMode();
+        if (ImGui::Combo("Mode", &mode, modes, IM_ARRAYSIZE(modes)))
+        {
+            framePacer.SetMode(static_cast<FramePacingMode>(mode));
+        }
+        int targetRate = framePacer.GetTargetRate();
+        if (ImGui::InputInt("Target FPS", &targetRate))
+        {
+            framePacer.SetTargetRate(targetRate);
+        }
+        FrameStats stats = framePacer.GetStats();
+        ImGui::Text("Frame time over the last %d frames", stats.frameCount);
+        ImGui::Text("average %.2f ms (%.0f fps)", stats.averageMs, stats.averageMs > 0.0 ? 1000.0 / stats.averageMs : 0.0);
+        ImGui::Text("min %.2f ms, max %.2f ms, 99th %.2f ms", stats.minMs, stats.maxMs, stats.p99Ms);
+        ImGui::Text("jitter %.3f ms", stats.jitterMs);
+        InputLatencyStats latency = inputLatencyTracker.GetStats();
+        ImGui::Text("Input to present over the last %d events (L toggles low latency input)", latency.sampleCount);
+        ImGui::Text("average %.1f ms, max %.1f ms, from poll %.2f ms", latency.averageMs, latency.maxMs, latency.averagePollToPresentMs);
+        ImGui::End();
+
         // ImGui demo window
         // ImGui::ShowDemoWindow();
 
         ImGui::Render();
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
+        auto guiDrawData = std::make_shared<GuiDrawData>(*ImGui::GetDrawData());
+        commands.Callback([guiDrawData](SDL_Renderer *renderer)
+                          { ImGui_ImplSDLRenderer2_RenderDrawData(&guiDrawData->drawData, renderer); });
     }
 };
\ No newline at end of file
@@ -5,12 +5,87 @@
 #include "../Components/HealthComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "CullingSystem.h"
+#include "../AssetStore/TextureAtlas.h"
+#include "../Renderer/SpriteBatcher.h"
+#include "../Renderer/RenderCommandList.h"
+#include "../Logger/Logger.h"
 #include <SDL2/SDL_ttf.h>
 #include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 
 class RenderHealthUISystem : public System
 {
+private:
+    // health bands, each drawn in its own color
+    static constexpr int BAND_COUNT = 3;
+    const SDL_Color bandColors[BAND_COUNT] = {{255, 0, 0, 255}, {255, 255, 0, 255}, {0, 255, 0, 255}};
+    std::vector<SDL_Rect> barRects[BAND_COUNT];
+
+    // "0%" to "100%" rendered once in their band colors and packed into one texture, on the render thread
+    static constexpr int MAX_LABEL = 100;
+    static constexpr int LABEL_STRIP_SIZE = 1024;
+    SDL_Texture *labelStrip = nullptr;
+    SDL_Rect labelRects[MAX_LABEL + 1];
+    SpriteBatcher labelBatcher;
+
+    struct HealthLabel
+    {
+        int label;
+        SDL_FRect dstRect;
+    };
+
+    // The labels of a frame are drawn by its callback on the render thread while the next frame is recorded.
+    // The game is never more than one frame ahead, so two buffers used in turn are enough and keep their memory.
+    std::vector<HealthLabel> labelBuffers[2];
+    int labelBuffer = 0;
+
+    static int GetBand(int health)
+    {
+        if (health >= 70)
+        {
+            return 2;
+        }
+        if (health >= 30)
+        {
+            return 1;
+        }
+        return 0;
+    }
+
+    void BuildLabelStrip(SDL_Renderer *renderer, TTF_Font *font)
+    {
+        if (!font)
+        {
+            return;
+        }
+
+        TextureAtlas strip(LABEL_STRIP_SIZE, LABEL_STRIP_SIZE);
+        for (int health = 0; health <= MAX_LABEL; health++)
+        {
+            labelRects[health] = {0, 0, 0, 0};
+            std::string text = std::to_string(health) + "%";
+            SDL_Surface *surface = TTF_RenderText_Blended(font, text.c_str(), bandColors[GetBand(health)]);
+            if (!surface)
+            {
+                continue;
+            }
+            if (strip.Pack(surface->w, surface->h, labelRects[health]))
+            {
+                strip.Blit(surface, labelRects[health]);
+            }
+            else
+            {
+                Logger::Err("Health label strip is full at " + text);
+            }
+            SDL_FreeSurface(surface);
+        }
+        labelStrip = strip.CreateTexture(renderer);
+        labelBatcher.ClearTextureCache();
+    }
+
 public:
     RenderHealthUISystem()
     {
@@ -19,58 +94,89 @@ public:
         RequireComponent<SpriteComponent>();
     }
 
-    void Update(SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore, const SDL_Rect &camera)
+    ~RenderHealthUISystem()
     {
-        for (auto entity : GetSystemEntities())
+        Clear();
+    }
+
+    // The label strip belongs to the renderer, call on the render thread. It is rendered again on the next frame
+    void Clear()
+    {
+        if (labelStrip)
+        {
+            SDL_DestroyTexture(labelStrip);
+            labelStrip = nullptr;
+        }
+        labelBatcher.ClearTextureCache();
+    }
+
+    // Only entities in the visible set get a health bar.
+    // The bars go out with one SDL_RenderFillRects per color and the labels with a single batched draw.
+    void Update(RenderCommandList &commands, std::unique_ptr<AssetStore> &assetStore, const SDL_Rect &camera, double alpha, const CullingSystem &culling)
+    {
+        for (auto &rects : barRects)
         {
+            rects.clear();
+        }
+        std::vector<HealthLabel> &labels = labelBuffers[labelBuffer];
+        labels.clear();
 
-            const auto healthComponent = entity.GetComponent<HealthComponent>();
-            const auto transform = entity.GetComponent<TransformComponent>();
-            const auto spriteComponent = entity.GetComponent<SpriteComponent>();
+        for (auto entity : culling.GetVisibleEntities())
+        {
+            if (!entity.HasComponent<HealthComponent>() || !entity.HasComponent<SpriteComponent>())
+            {
+                continue;
+            }
 
-            std::string text = std::to_string(healthComponent.health) + "%";
-            SDL_Color color = {255, 255, 255};
+            const auto &healthComponent = entity.GetComponent<HealthComponent>();
+            glm::vec2 position = entity.GetComponent<TransformComponent>().position;
+            if (entity.HasComponent<RigidBodyComponent>())
+            {
+                const auto &transform = entity.GetComponent<TransformComponent>();
+                position = glm::mix(transform.previousPosition, transform.position, static_cast<float>(alpha));
+            }
 
             SDL_Rect r;
-            r.x = transform.position.x - camera.x;
-            r.y = transform.position.y + TILE_SIZE - camera.y;
+            r.x = position.x - camera.x;
+            r.y = position.y + TILE_SIZE - camera.y;
             r.w = (30 * (healthComponent.health / 100.0));
             r.h = 8;
+            barRects[GetBand(healthComponent.health)].push_back(r);
 
-            if (healthComponent.health >= 70)
+            // the strip covers 0 to 100%, anything outside shows the nearest label
+            labels.push_back({glm::clamp(healthComponent.health, 0, MAX_LABEL), {position.x - 10 - camera.x, position.y - 10 - camera.y, 25, 25}});
+        }
+
+        for (int band = 0; band < BAND_COUNT; band++)
+        {
+            commands.FillRects(bandColors[band], barRects[band].data(), barRects[band].size());
+        }
+
+        if (labels.empty())
+        {
+            return;
+        }
+        labelBuffer = 1 - labelBuffer;
+        TTF_Font *font = assetStore->GetFont("charriot-font");
+        commands.Callback([this, &labels, font](SDL_Renderer *renderer)
+                          {
+            if (!labelStrip)
             {
-                color = {0, 255, 0};
+                BuildLabelStrip(renderer, font);
             }
-            else if (healthComponent.health >= 30)
+            if (!labelStrip)
             {
-                color = {255, 255, 0};
+                return;
             }
-            else if (healthComponent.health < 30)
+
+            labelBatcher.Begin();
+            for (const auto &label : labels)
             {
-                color = {255, 0, 0};
+                if (labelRects[label.label].w > 0)
+                {
+                    labelBatcher.Draw(labelStrip, labelRects[label.label], label.dstRect, 0.0, SDL_FLIP_NONE, 0);
+                }
             }
-            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
-            SDL_RenderFillRect(renderer, &r);
-            SDL_Surface *surface = TTF_RenderText_Blended(
-                assetStore->GetFont("charriot-font"),
-                text.c_str(),
-                color);
-            SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-            SDL_FreeSurface(surface);
-
-            int labelWidth = 0;
-            int labelHeight = 0;
-            SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
-
-            SDL_Rect dstRect = {
-                static_cast<int>(transform.position.x - 10 - (camera.x)),
-                static_cast<int>(transform.position.y - 10 - (camera.y)),
-                25,
-                25};
-
-            SDL_RenderCopy(renderer, texture, NULL, &dstRect);
-
-            SDL_DestroyTexture(texture);
-        }
+            labelBatcher.End(renderer); });
     }
 };
@@ -4,11 +4,92 @@
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
 #include <SDL2/SDL.h>
 #include "../AssetStore/AssetStore.h"
+#include "../Renderer/SpriteBatcher.h"
+#include "CullingSystem.h"
+#include <map>
+#include <unordered_map>
 
 class RenderSystem : public System
 {
+private:
+    // Retained render queue: one bucket of entity handles per zIndex, drawn in ascending zIndex order.
+    // Entities are added and removed with the system instead of the queue being rebuilt every frame,
+    // and the place of an entity in the queue is its draw order.
+    struct RenderItem
+    {
+        Entity entity;
+        bool isRemoved;
+    };
+
+    struct Layer
+    {
+        std::vector<RenderItem> items;
+        int removedCount = 0;
+    };
+
+    std::map<int, Layer> layers;
+
+    // where each entity sits in the queue, so it can be removed without searching the layers
+    struct QueueSlot
+    {
+        int zIndex;
+        size_t index;
+    };
+    std::unordered_map<EntityId, QueueSlot> queueSlots;
+
+    // entities whose sprite changed zIndex since they were queued, moved once the layers have been drawn
+    std::vector<Entity> changedLayer;
+
+    std::vector<QueueSlot> visibleItems;
+
+    SpriteBatcher spriteBatcher;
+    std::vector<SDL_Rect> colliderRects; // drawn over the sprites once the batches are submitted
+
+    void Enqueue(Entity entity, int zIndex)
+    {
+        Layer &layer = layers[zIndex];
+        queueSlots[entity.GetId()] = QueueSlot{zIndex, layer.items.size()};
+        layer.items.push_back(RenderItem{entity, false});
+    }
+
+    void Dequeue(EntityId entityId)
+    {
+        auto slot = queueSlots.find(entityId);
+        if (slot == queueSlots.end())
+        {
+            return;
+        }
+
+        // removed items are only marked, the draw pass compacts the layer so the draw order is kept
+        Layer &layer = layers[slot->second.zIndex];
+        layer.items[slot->second.index].isRemoved = true;
+        layer.removedCount++;
+        queueSlots.erase(slot);
+    }
+
+    void CompactLayer(Layer &layer)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < layer.items.size(); i++)
+        {
+            if (layer.items[i].isRemoved)
+            {
+                continue;
+            }
+            if (kept != i)
+            {
+                layer.items[kept] = layer.items[i];
+                queueSlots[layer.items[kept].entity.GetId()].index = kept;
+            }
+            kept++;
+        }
+        layer.items.erase(layer.items.begin() + kept, layer.items.end());
+        layer.removedCount = 0;
+    }
+
 public:
     RenderSystem()
     {
@@ -16,65 +97,103 @@ public:
         RequireComponent<SpriteComponent>();
     }
 
-    void Update(SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore, bool renderColliders, SDL_Rect &camera)
+    int GetDrawCallCount() const { return spriteBatcher.GetDrawCallCount(); }
+
+    void AddEntityToSystem(Entity entity) override
     {
-        struct RenderableEntity
-        {
-            TransformComponent transformComponent;
-            SpriteComponent spriteComponent;
-            bool hasCollider;
-        };
+        System::AddEntityToSystem(entity);
+        Enqueue(entity, entity.GetComponent<SpriteComponent>().zIndex);
+    }
+
+    void RemoveEntityFromSystem(Entity entity) override
+    {
+        System::RemoveEntityFromSystem(entity);
+        Dequeue(entity.GetId());
+    }
 
-        std::vector<RenderableEntity>
-            renderableEntities;
+    // Draws the entities the culling pass found visible, in queue order: by zIndex, then by when they were queued.
+    // alpha is how far the frame is between the last two simulation ticks, moving entities are drawn in between
+    void Update(RenderCommandList &commands, std::unique_ptr<AssetStore> &assetStore, bool renderColliders, SDL_Rect &camera, double alpha, const CullingSystem &culling)
+    {
+        changedLayer.clear();
+        colliderRects.clear();
+        spriteBatcher.Begin();
 
-        // sort entities by z index
-        for (auto entity : GetSystemEntities())
+        for (auto layer = layers.begin(); layer != layers.end();)
         {
-            RenderableEntity renderableEntity;
-            renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
-            renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-            renderableEntity.hasCollider = entity.HasComponent<BoxColliderComponent>();
-
-            // only render entities that are in the camera view
-            bool outsideCameraView = (renderableEntity.transformComponent.position.x + renderableEntity.spriteComponent.width * renderableEntity.transformComponent.scale.x < camera.x ||
-                                      renderableEntity.transformComponent.position.x > camera.x + camera.w ||
-                                      renderableEntity.transformComponent.position.y + renderableEntity.spriteComponent.height * renderableEntity.transformComponent.scale.y < camera.y ||
-                                      renderableEntity.transformComponent.position.y > camera.y + camera.h);
-
-            if (outsideCameraView && !renderableEntity.spriteComponent.isFixed)
+            if (layer->second.removedCount > 0)
+            {
+                CompactLayer(layer->second);
+            }
+            if (layer->second.items.empty())
             {
+                layer = layers.erase(layer);
                 continue;
             }
-
-            renderableEntities.emplace_back(renderableEntity);
+            layer++;
         }
 
-        std::sort(renderableEntities.begin(), renderableEntities.end(), [](const RenderableEntity &a, const RenderableEntity &b)
-                  { return a.spriteComponent.zIndex < b.spriteComponent.zIndex; });
+        // only the visible entities are sorted, by their place in the queue
+        visibleItems.clear();
+        for (auto entity : culling.GetVisibleEntities())
+        {
+            auto slot = queueSlots.find(entity.GetId());
+            if (slot != queueSlots.end())
+            {
+                visibleItems.push_back(slot->second);
+            }
+        }
+        std::sort(visibleItems.begin(), visibleItems.end(), [](const QueueSlot &a, const QueueSlot &b)
+                  { return a.zIndex < b.zIndex || (a.zIndex == b.zIndex && a.index < b.index); });
 
-        for (auto entity : renderableEntities)
+        for (const auto &slot : visibleItems)
         {
-            const auto transform = entity.transformComponent;
-            const auto sprite = entity.spriteComponent;
-
-            SDL_Rect dstRect = {
-                static_cast<int>(transform.position.x - (!sprite.isFixed ? camera.x : 0)), // shift rendering sprites by camera position
-                static_cast<int>(transform.position.y - (!sprite.isFixed ? camera.y : 0)),
-                static_cast<int>(sprite.width * transform.scale.x),
-                static_cast<int>(sprite.height * transform.scale.y),
+            Entity entity = layers[slot.zIndex].items[slot.index].entity;
+            const auto &transform = entity.GetComponent<TransformComponent>();
+            const auto &sprite = entity.GetComponent<SpriteComponent>();
+
+            if (sprite.zIndex != slot.zIndex)
+            {
+                changedLayer.push_back(entity);
+            }
+
+            glm::vec2 position = transform.position;
+            if (entity.HasComponent<RigidBodyComponent>())
+            {
+                position = glm::mix(transform.previousPosition, transform.position, static_cast<float>(alpha));
+            }
+
+            SDL_FRect dstRect = {
+                position.x - (!sprite.isFixed ? camera.x : 0), // shift rendering sprites by camera position
+                position.y - (!sprite.isFixed ? camera.y : 0),
+                sprite.width * transform.scale.x,
+                sprite.height * transform.scale.y,
             };
 
-            SDL_Rect srcRect = sprite.srcRect;
+            // the sprite's source rect is in its own image, move it to where the image sits in the atlas
+            const TextureRegion &region = assetStore->GetTextureRegion(sprite.assetId);
+            SDL_Rect srcRect = {
+                sprite.srcRect.x + region.rect.x,
+                sprite.srcRect.y + region.rect.y,
+                sprite.srcRect.w,
+                sprite.srcRect.h};
 
-            SDL_RenderCopyEx(renderer, assetStore->GetTexture(sprite.assetId), &srcRect, &dstRect, transform.rotation, nullptr, sprite.flip);
+            spriteBatcher.Draw(region.texture, srcRect, dstRect, transform.rotation, sprite.flip, slot.zIndex);
 
-            if (entity.hasCollider && renderColliders)
+            if (renderColliders && entity.HasComponent<BoxColliderComponent>())
             {
-
-                SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-                SDL_RenderDrawRect(renderer, &dstRect);
+                colliderRects.push_back({static_cast<int>(dstRect.x), static_cast<int>(dstRect.y), static_cast<int>(dstRect.w), static_cast<int>(dstRect.h)});
             }
         }
+
+        spriteBatcher.End(commands);
+        commands.DrawRects({255, 0, 0, 255}, colliderRects.data(), colliderRects.size());
+
+        // a zIndex change takes effect from the next frame
+        for (auto entity : changedLayer)
+        {
+            Dequeue(entity.GetId());
+            Enqueue(entity, entity.GetComponent<SpriteComponent>().zIndex);
+        }
     }
-};
\ No newline at end of file
+};
@@ -5,10 +5,31 @@
 #include "../ECS/ECS.h"
 #include "../Components/UILabelComponent.h"
 #include "../Components/TransformComponent.h"
+#include "CullingSystem.h"
+#include "../Renderer/TextRenderer.h"
+#include "../Renderer/RenderCommandList.h"
 #include <SDL2/SDL.h>
+#include <string>
+#include <vector>
 
 class RenderTextSystem : public System
 {
+private:
+    // what the render thread needs to draw a label, copied when the frame is recorded
+    struct Label
+    {
+        EntityId id;
+        std::string text;
+        std::string fontId;
+        TTF_Font *font;
+        SDL_Color color;
+        int x;
+        int y;
+    };
+
+    TextRenderer textRenderer; // only used on the render thread
+    std::vector<EntityId> removedLabels;
+
 public:
     RenderTextSystem()
     {
@@ -16,35 +37,59 @@ public:
         RequireComponent<TransformComponent>();
     }
 
-    void Update(SDL_Renderer *renderer, std::unique_ptr<AssetStore> &assetStore, const SDL_Rect &camera)
+    void RemoveEntityFromSystem(Entity entity) override
     {
-        for (auto entity : GetSystemEntities())
-        {
-            const auto textlabel = entity.GetComponent<UILabelComponent>();
-            const auto transform = entity.GetComponent<TransformComponent>();
+        System::RemoveEntityFromSystem(entity);
+        removedLabels.push_back(entity.GetId());
+    }
 
-            SDL_Surface *surface = TTF_RenderText_Blended(
-                assetStore->GetFont(textlabel.assetId),
-                textlabel.text.c_str(),
-                textlabel.color);
-            SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-            SDL_FreeSurface(surface);
+    // The glyph atlases belong to the renderer, call on the render thread
+    void Clear()
+    {
+        textRenderer.Clear();
+    }
 
-            int labelWidth = 0;
-            int labelHeight = 0;
+    int GetDrawCallCount() const { return textRenderer.GetDrawCallCount(); }
 
-            SDL_QueryTexture(texture, NULL, NULL, &labelWidth, &labelHeight);
+    // Only labels in the visible set are rendered, fixed labels always are.
+    // The glyphs are rasterized and laid out when the frame is executed, on the thread that owns the renderer.
+    void Update(RenderCommandList &commands, std::unique_ptr<AssetStore> &assetStore, const SDL_Rect &camera, const CullingSystem &culling)
+    {
+        std::vector<Label> labels;
+        for (auto entity : culling.GetVisibleEntities())
+        {
+            if (!entity.HasComponent<UILabelComponent>())
+            {
+                continue;
+            }
+            const auto &textlabel = entity.GetComponent<UILabelComponent>();
+            const auto &transform = entity.GetComponent<TransformComponent>();
 
-            SDL_Rect dstRect = {
+            labels.push_back({
+                entity.GetId(),
+                textlabel.text,
+                textlabel.assetId,
+                assetStore->GetFont(textlabel.assetId),
+                textlabel.color,
                 static_cast<int>(transform.position.x - (transform.isFixed ? 0 : camera.x)),
                 static_cast<int>(transform.position.y - (transform.isFixed ? 0 : camera.y)),
-                labelWidth,
-                labelHeight};
+            });
+        }
 
-            SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+        commands.Callback([this, labels = std::move(labels), removedLabels = std::move(removedLabels)](SDL_Renderer *renderer)
+                          {
+            for (EntityId id : removedLabels)
+            {
+                textRenderer.Forget(id);
+            }
 
-            SDL_DestroyTexture(texture);
-        }
+            textRenderer.Begin();
+            for (const auto &label : labels)
+            {
+                textRenderer.Draw(label.id, label.text, label.fontId, label.font, label.color, label.x, label.y, renderer);
+            }
+            textRenderer.End(renderer); });
+        removedLabels.clear();
     }
 };
 
@@ -6,6 +6,9 @@
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/AnimationComponent.h"
 #include "../Components/ProjectileEmmitterComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "AnimationSystem.h"
+#include "../Physics/AABB.h"
 #include <tuple>
 
 std::tuple<double, double> GetEntityPosition(Entity entity)
@@ -81,8 +84,8 @@ void SetEntityAnimationFrame(Entity entity, int frame)
 {
     if (entity.HasComponent<AnimationComponent>())
     {
-        auto &animation = entity.GetComponent<AnimationComponent>();
-        animation.currentFrame = frame;
+        // through the animation system, so the sprite shows the frame now and the next change is timed from it
+        entity.registry->GetSystem<AnimationSystem>().SetFrame(entity, frame);
     }
     else
     {
@@ -104,15 +107,36 @@ void SetProjectileVelocity(Entity entity, double x, double y)
     }
 }
 
+// Writes the entities into results[1..n] and clears what a previous, longer query left after them,
+// so a script can keep one table per query and reuse it every frame
+int FillResultsTable(sol::table &results, const std::vector<Entity> &entities)
+{
+    int previousSize = results.size();
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        results[i + 1] = entities[i];
+    }
+    for (int i = entities.size() + 1; i <= previousSize; i++)
+    {
+        results[i] = sol::lua_nil;
+    }
+    return entities.size();
+}
+
 class ScriptSystem : public System
 {
+private:
+    // reused by every spatial query made from Lua
+    std::vector<Entity> queryResults;
+    std::vector<EntityHit> rayHits;
+
 public:
     ScriptSystem()
     {
         RequireComponent<ScriptComponent>();
     }
 
-    void CreateLuaBindings(sol::state &lua)
+    void CreateLuaBindings(sol::state &lua, std::unique_ptr<Registry> &registry)
     {
         // Create the "entity" usertype so Lua knows what an entity is
         lua.new_usertype<Entity>(
@@ -130,6 +154,50 @@ public:
         lua.set_function("set_rotation", SetEntityRotation);
         lua.set_function("set_projectile_velocity", SetProjectileVelocity);
         lua.set_function("set_animation_frame", SetEntityAnimationFrame);
+
+        // Spatial queries, e.g. local targets, count = query_radius(x, y, 200, targets, collision_layer.player)
+        // They fill the optional results table (a new one is made when it's missing) and return it with the hit count.
+        // The mask defaults to every layer.
+        lua["collision_layer"] = lua.create_table_with(
+            "default", COLLISION_LAYER_DEFAULT,
+            "player", COLLISION_LAYER_PLAYER,
+            "enemy", COLLISION_LAYER_ENEMY,
+            "projectile", COLLISION_LAYER_PROJECTILE,
+            "obstacle", COLLISION_LAYER_OBSTACLE,
+            "tile", COLLISION_LAYER_TILE,
+            "all", COLLISION_LAYER_ALL);
+
+        Registry *queryRegistry = registry.get();
+        lua.set_function("query_aabb", [this, queryRegistry](sol::this_state state, double x, double y, double width, double height, sol::optional<sol::table> results, sol::optional<unsigned int> mask)
+                         {
+            sol::table table = results ? results.value() : sol::state_view(state).create_table();
+            queryResults.clear();
+            queryRegistry->QueryAABB(AABB(glm::vec2(x, y), glm::vec2(x + width, y + height)), queryResults, mask.value_or(COLLISION_LAYER_ALL));
+            int count = FillResultsTable(table, queryResults);
+            return std::make_tuple(table, count); });
+
+        lua.set_function("query_radius", [this, queryRegistry](sol::this_state state, double x, double y, double radius, sol::optional<sol::table> results, sol::optional<unsigned int> mask)
+                         {
+            sol::table table = results ? results.value() : sol::state_view(state).create_table();
+            queryResults.clear();
+            queryRegistry->QueryRadius(glm::vec2(x, y), radius, queryResults, mask.value_or(COLLISION_LAYER_ALL));
+            int count = FillResultsTable(table, queryResults);
+            return std::make_tuple(table, count); });
+
+        // Entities along the segment, closest first, also returns the point where the closest one was hit
+        lua.set_function("raycast", [this, queryRegistry](sol::this_state state, double x1, double y1, double x2, double y2, sol::optional<sol::table> results, sol::optional<unsigned int> mask)
+                         {
+            sol::table table = results ? results.value() : sol::state_view(state).create_table();
+            rayHits.clear();
+            queryRegistry->Raycast(glm::vec2(x1, y1), glm::vec2(x2, y2), rayHits, mask.value_or(COLLISION_LAYER_ALL));
+            queryResults.clear();
+            for (const auto &hit : rayHits)
+            {
+                queryResults.push_back(hit.entity);
+            }
+            int count = FillResultsTable(table, queryResults);
+            glm::vec2 point = rayHits.empty() ? glm::vec2(x2, y2) : rayHits.front().point;
+            return std::make_tuple(table, count, point.x, point.y); });
     }
 
     void Update(double deltaTime, int ellapsedTime)
@@ -0,0 +1,108 @@
+#include "ThreadPool.h"
+#include "../Logger/Logger.h"
+
+ThreadPool::ThreadPool(int numWorkers)
+{
+    if (numWorkers < 0)
+    {
+        numWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+    }
+
+    for (int i = 0; i < numWorkers; i++)
+    {
+        // thread 0 is the caller of ParallelFor
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i + 1);
+    }
+    Logger::Log("ThreadPool created with " + std::to_string(numWorkers) + " workers");
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::RunJobs(const std::function<void(int, int)> &job, int count, int thread)
+{
+    int index;
+    while ((index = nextJob.fetch_add(1)) < count)
+    {
+        job(index, thread);
+    }
+}
+
+void ThreadPool::WorkerLoop(int thread)
+{
+    unsigned int lastGeneration = 0;
+    while (true)
+    {
+        const std::function<void(int, int)> *currentJob;
+        int count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&]
+                               { return isStopping || generation != lastGeneration; });
+            if (isStopping)
+            {
+                return;
+            }
+            lastGeneration = generation;
+            currentJob = job;
+            count = jobCount;
+        }
+
+        RunJobs(*currentJob, count, thread);
+
+        bool isLast;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isLast = ++finishedWorkers == static_cast<int>(workers.size());
+        }
+        if (isLast)
+        {
+            workDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int index, int thread)> &job)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (workers.empty() || count == 1)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            job(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        jobCount = count;
+        nextJob = 0;
+        finishedWorkers = 0;
+        generation++;
+    }
+    workAvailable.notify_all();
+
+    RunJobs(job, count, 0);
+
+    // every job has been claimed, wait for every worker to be done with this call, including the ones that
+    // woke up too late to get a job
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [&]
+                  { return finishedWorkers == static_cast<int>(workers.size()); });
+    this->job = nullptr;
+}
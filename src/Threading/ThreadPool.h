@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ThreadPool
+A fixed set of worker threads that sleep until ParallelFor hands them a range of jobs.
+The calling thread works on the jobs too, so a pool with no workers just runs them inline.
+*/
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    // The current ParallelFor call, workers pick it up when the generation changes.
+    // The call only returns once every worker has finished with its generation, so no worker can still be
+    // claiming jobs from it when the next call resets the counter.
+    const std::function<void(int, int)> *job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextJob{0};
+    int finishedWorkers = 0;
+    unsigned int generation = 0;
+    bool isStopping = false;
+
+    void WorkerLoop(int worker);
+    void RunJobs(const std::function<void(int, int)> &job, int count, int thread);
+
+public:
+    // By default one worker per core, minus the calling thread
+    ThreadPool(int numWorkers = -1);
+    ~ThreadPool();
+
+    // Number of threads that take part in ParallelFor, including the caller
+    int GetThreadCount() const { return workers.size() + 1; }
+
+    // Calls job(index, thread) for every index in [0, count) and returns when all of them are done.
+    // thread is in [0, GetThreadCount()), so jobs can write to per-thread buffers without locking.
+    void ParallelFor(int count, const std::function<void(int index, int thread)> &job);
+};